@@ -0,0 +1,363 @@
+// Microbenchmarks for the Converter hot paths.
+//
+//   le_bench                        all benchmarks, inputs up to 1M lines
+//   LE_BENCH_LARGE=1 le_bench       adds the 10M-line inputs (~600 MB on disk)
+//   le_bench convertM3uToM3u8:unicode/100k
+//
+// Besides QtTest's own timing, every benchmark prints its throughput in
+// entries/s and MB/s (UTF-8 input bytes).
+
+#include "Converter.h"
+#include "PathKernels.h"
+#include "PlaylistGenerator.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+#include <vector>
+
+using namespace LE;
+
+namespace {
+
+enum class Flavor {
+    Ascii,      // Clean ASCII paths, no directives
+    Unicode,    // Every path component from the non-ASCII pool
+    Messy,      // Mixed, doubled and trailing separators everywhere
+    Mixed       // The generator's defaults: #EXTINF, comments, blanks, some of everything
+};
+
+const char* flavorName(Flavor flavor)
+{
+    switch (flavor) {
+        case Flavor::Ascii:   return "ascii";
+        case Flavor::Unicode: return "unicode";
+        case Flavor::Messy:   return "messy";
+        case Flavor::Mixed:   return "mixed";
+    }
+    return "?";
+}
+
+constexpr Flavor kFlavors[] = {Flavor::Ascii, Flavor::Unicode, Flavor::Messy, Flavor::Mixed};
+
+GeneratorOptions generatorOptions(Flavor flavor, GeneratorOptions::Format format, qint64 entries)
+{
+    GeneratorOptions options;
+    options.seed    = 0x4C45;
+    options.entries = entries;
+    options.format  = format;
+
+    if (flavor != Flavor::Mixed) {
+        options.extinfRatio   = 0.0;
+        options.commentRatio  = 0.0;
+        options.blankRatio    = 0.0;
+        options.messyRatio    = (flavor == Flavor::Messy) ? 1.0 : 0.0;
+        options.nonAsciiRatio = (flavor == Flavor::Unicode) ? 1.0 : 0.0;
+    }
+    return options;
+}
+
+// Library-relative entries, as found in M3U playlists.
+QStringList makeEntries(Flavor flavor, int count)
+{
+    PlaylistGenerator generator(generatorOptions(flavor, GeneratorOptions::Format::M3u, count));
+    QStringList entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        entries << generator.nextEntry();
+    }
+    return entries;
+}
+
+qint64 utf8Size(const QStringList& entries)
+{
+    qint64 bytes = 0;
+    for (const QString& entry : entries) {
+        bytes += entry.toUtf8().size() + 1;
+    }
+    return bytes;
+}
+
+void reportThroughput(qint64 lines, qint64 bytes, qint64 nsecs)
+{
+    const double seconds = std::max<qint64>(nsecs, 1) / 1e9;
+    qInfo().noquote() << QString("    %L1 entries/s, %2 MB/s")
+                             .arg(static_cast<qint64>(lines / seconds))
+                             .arg(bytes / seconds / 1e6, 0, 'f', 1);
+}
+
+struct InputSize {
+    const char* tag;
+    int         lines;
+};
+
+QList<InputSize> inputSizes()
+{
+    QList<InputSize> sizes = {{"1k", 1'000}, {"10k", 10'000}, {"100k", 100'000}, {"1M", 1'000'000}};
+    if (qEnvironmentVariableIntValue("LE_BENCH_LARGE") != 0) {
+        sizes.append({"10M", 10'000'000});
+    }
+    return sizes;
+}
+
+} // namespace
+
+class ConverterBench : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void normalizePath_data();
+    void normalizePath();
+    void normalizeKernel_data();
+    void normalizeKernel();
+    void normalizeKernelUtf8_data();
+    void normalizeKernelUtf8();
+    void stripLeadingMusicPrefix_data();
+    void stripLeadingMusicPrefix();
+
+    void convertM3uToM3u8_data();
+    void convertM3uToM3u8();
+    void convertM3u8ToM3u_data();
+    void convertM3u8ToM3u();
+
+private:
+    void addFlavorRows();
+    void addPlaylistRows();
+    void benchmarkConversion(const QString& suffix);
+
+    // Generated playlist for a (flavor, size, suffix) row, created on first use.
+    QString playlistFor(Flavor flavor, int lines, const QString& suffix);
+
+    QTemporaryDir           m_dir;
+    QHash<QString, QString> m_playlists;
+};
+
+void ConverterBench::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    qInfo() << "Path kernel:" << PathKernels::activeKernelName();
+}
+
+void ConverterBench::addFlavorRows()
+{
+    QTest::addColumn<int>("flavor");
+    for (Flavor flavor : kFlavors) {
+        QTest::newRow(flavorName(flavor)) << static_cast<int>(flavor);
+    }
+}
+
+void ConverterBench::addPlaylistRows()
+{
+    QTest::addColumn<int>("flavor");
+    QTest::addColumn<int>("lines");
+    for (Flavor flavor : kFlavors) {
+        for (const InputSize& size : inputSizes()) {
+            QTest::addRow("%s/%s", flavorName(flavor), size.tag) << static_cast<int>(flavor) << size.lines;
+        }
+    }
+}
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+
+void ConverterBench::normalizePath_data()
+{
+    addFlavorRows();
+}
+
+void ConverterBench::normalizePath()
+{
+    QFETCH(int, flavor);
+    const QStringList entries = makeEntries(static_cast<Flavor>(flavor), 10'000);
+
+    qint64 rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        for (const QString& entry : entries) {
+            QString result = Converter::normalizePath(entry);
+            Q_UNUSED(result);
+        }
+        ++rounds;
+    }
+
+    reportThroughput(rounds * entries.size(), rounds * utf8Size(entries), timer.nsecsElapsed());
+}
+
+// The separator kernel alone, runtime-selected vs. the scalar reference.
+void ConverterBench::normalizeKernel_data()
+{
+    QTest::addColumn<int>("flavor");
+    QTest::addColumn<bool>("scalar");
+    for (Flavor flavor : kFlavors) {
+        QTest::addRow("%s/%s", flavorName(flavor), PathKernels::activeKernelName()) << static_cast<int>(flavor) << false;
+        QTest::addRow("%s/scalar", flavorName(flavor)) << static_cast<int>(flavor) << true;
+    }
+}
+
+void ConverterBench::normalizeKernel()
+{
+    QFETCH(int, flavor);
+    QFETCH(bool, scalar);
+    const QStringList entries = makeEntries(static_cast<Flavor>(flavor), 10'000);
+    using Kernel = qsizetype (*)(const char16_t*, qsizetype, char16_t*) noexcept;
+    const Kernel kernel = scalar ? Kernel(&PathKernels::collapseSeparatorsScalar) : Kernel(&PathKernels::collapseSeparators);
+
+    std::vector<char16_t> out(4096);
+    qint64 rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        for (const QString& entry : entries) {
+            kernel(QStringView(entry).utf16(), entry.size(), out.data());
+        }
+        ++rounds;
+    }
+
+    reportThroughput(rounds * entries.size(), rounds * utf8Size(entries), timer.nsecsElapsed());
+}
+
+// The byte kernel the conversion pipeline actually runs.
+void ConverterBench::normalizeKernelUtf8_data()
+{
+    normalizeKernel_data();
+}
+
+void ConverterBench::normalizeKernelUtf8()
+{
+    QFETCH(int, flavor);
+    QFETCH(bool, scalar);
+    QByteArrayList entries;
+    for (const QString& entry : makeEntries(static_cast<Flavor>(flavor), 10'000)) {
+        entries << entry.toUtf8();
+    }
+    using Kernel = qsizetype (*)(const char*, qsizetype, char*) noexcept;
+    const Kernel kernel = scalar ? Kernel(&PathKernels::collapseSeparatorsScalar) : Kernel(&PathKernels::collapseSeparators);
+
+    std::vector<char> out(16384);
+    qint64 bytes = 0;
+    for (const QByteArray& entry : entries) {
+        bytes += entry.size() + 1;
+    }
+    qint64 rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        for (const QByteArray& entry : entries) {
+            kernel(entry.constData(), entry.size(), out.data());
+        }
+        ++rounds;
+    }
+
+    reportThroughput(rounds * entries.size(), rounds * bytes, timer.nsecsElapsed());
+}
+
+void ConverterBench::stripLeadingMusicPrefix_data()
+{
+    addFlavorRows();
+}
+
+void ConverterBench::stripLeadingMusicPrefix()
+{
+    QFETCH(int, flavor);
+    const QStringList entries = makeEntries(static_cast<Flavor>(flavor), 10'000);
+
+    qint64 rounds = 0;
+    qsizetype total = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        for (const QString& entry : entries) {
+            total += Converter::stripLeadingMusicPrefix(entry).size();
+        }
+        ++rounds;
+    }
+
+    QVERIFY(total > 0);
+    reportThroughput(rounds * entries.size(), rounds * utf8Size(entries), timer.nsecsElapsed());
+}
+
+// ─── Full conversions ────────────────────────────────────────────────────────
+
+QString ConverterBench::playlistFor(Flavor flavor, int lines, const QString& suffix)
+{
+    const QString key = QString("%1-%2%3").arg(flavorName(flavor)).arg(lines).arg(suffix);
+    if (const auto it = m_playlists.constFind(key); it != m_playlists.cend()) {
+        return *it;
+    }
+
+    const QString path = m_dir.filePath(key);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qFatal("Cannot create benchmark input %s", qPrintable(path));
+    }
+
+    // Plain M3U entries are library-relative; M3U8 entries are absolute.
+    const auto format = (suffix == ".m3u8") ? GeneratorOptions::Format::M3u8 : GeneratorOptions::Format::M3u;
+    PlaylistGenerator generator(generatorOptions(flavor, format, lines));
+    if (!generator.write(file)) {
+        qFatal("Cannot write benchmark input %s", qPrintable(path));
+    }
+
+    m_playlists.insert(key, path);
+    return path;
+}
+
+void ConverterBench::benchmarkConversion(const QString& suffix)
+{
+    QFETCH(int, flavor);
+    QFETCH(int, lines);
+
+    ConversionParams params;
+    params.inputPath  = playlistFor(static_cast<Flavor>(flavor), lines, suffix);
+    params.outputPath = m_dir.filePath(suffix == ".m3u" ? "out.m3u8" : "out.m3u");
+    params.basePath   = "D:\\Library";
+    params.intraFileParallel = true;
+
+    const qint64 inputBytes = QFileInfo(params.inputPath).size();
+
+    Converter converter;
+    qint64 rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        converter.convert(params);
+        ++rounds;
+    }
+
+    reportThroughput(rounds * lines, rounds * inputBytes, timer.nsecsElapsed());
+}
+
+void ConverterBench::convertM3uToM3u8_data()
+{
+    addPlaylistRows();
+}
+
+void ConverterBench::convertM3uToM3u8()
+{
+    benchmarkConversion(".m3u");
+}
+
+void ConverterBench::convertM3u8ToM3u_data()
+{
+    addPlaylistRows();
+}
+
+void ConverterBench::convertM3u8ToM3u()
+{
+    benchmarkConversion(".m3u8");
+}
+
+QTEST_GUILESS_MAIN(ConverterBench)
+
+#include "ConverterBench.moc"
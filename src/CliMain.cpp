@@ -0,0 +1,592 @@
+#include "ConversionCache.h"
+#include "Converter.h"
+#include "IncrementalConverter.h"
+#include "LibraryIndex.h"
+#include "PlaylistOps.h"
+#include "PlaylistWatcher.h"
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+Q_LOGGING_CATEGORY(lcCli, "le.cli")
+
+namespace {
+
+// What to do with the inputs; everything but Convert leaves the format as is.
+enum class Operation {
+    Convert,
+    Sort,
+    Merge,
+    Split
+};
+
+struct CliOptions {
+    Operation operation = Operation::Convert;
+    QString basePath;
+    QString outputDir;
+    QString libraryIndex;
+    QString cacheDir;
+    qint64  cacheLimitMiB = 2048;
+    qint64  memoryMiB = 256;
+    QString tempDir;
+    QString mergeOutput;
+    qint64  partEntries = 0;
+    bool presorted = false;
+    LE::LocationMode locationMode = LE::LocationMode::Keep;
+    LE::ValidationMode validation = LE::ValidationMode::Off;
+    LE::InputEncoding inputEncoding = LE::InputEncoding::Auto;
+    bool recursive = false;
+    bool split = false;
+    bool stripDirectives = false;
+    bool dedup = false;
+    bool watch = false;
+    bool perfReport = false;
+    int  jobs = 0;
+};
+
+bool isPlaylist(const QString& path)
+{
+    return path.endsWith(".m3u", Qt::CaseInsensitive) ||
+           path.endsWith(".m3u8", Qt::CaseInsensitive);
+}
+
+bool hasWildcard(const QString& arg)
+{
+    return arg.contains('*') || arg.contains('?') || arg.contains('[');
+}
+
+// Expands one command-line argument into playlist files.
+// Accepts a file, a directory (scanned for *.m3u / *.m3u8) or a glob whose
+// wildcards are confined to the last path component, e.g. "D:/Lists/*.m3u".
+QStringList expandInput(const QString& arg, bool recursive)
+{
+    QStringList files;
+    const auto flags = recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags;
+
+    if (hasWildcard(arg)) {
+        const QFileInfo pattern(arg);
+        QDirIterator it(pattern.path(), {pattern.fileName()}, QDir::Files, flags);
+        while (it.hasNext()) {
+            const QString path = it.next();
+            if (isPlaylist(path)) files << path;
+        }
+    } else if (QFileInfo(arg).isDir()) {
+        QDirIterator it(arg, {"*.m3u", "*.m3u8"}, QDir::Files, flags);
+        while (it.hasNext()) {
+            files << it.next();
+        }
+    } else {
+        files << arg;
+    }
+
+    files.sort();
+    return files;
+}
+
+// <name>.sorted.<ext>, placed like a converted output.
+QString sortedPathFor(const QString& inputPath, const QString& outputDir)
+{
+    const QFileInfo info(inputPath);
+    const QDir dir(outputDir.isEmpty() ? info.absolutePath() : outputDir);
+    return dir.filePath(info.completeBaseName() + ".sorted." + info.suffix());
+}
+
+// M3U → .m3u8, M3U8 → .m3u, placed next to the input unless an output directory is given.
+QString outputPathFor(const QString& inputPath, const QString& outputDir)
+{
+    const QFileInfo info(inputPath);
+    const QString targetExt = inputPath.endsWith(".m3u", Qt::CaseInsensitive) ? ".m3u8" : ".m3u";
+    const QDir dir(outputDir.isEmpty() ? info.absolutePath() : outputDir);
+    return dir.filePath(info.completeBaseName() + targetExt);
+}
+
+// Identity of a file as Windows sees it: absolute, cleaned and case-folded,
+// so "A.m3u8" and "./a.M3U8" name the same output.
+QString fileKey(const QString& path)
+{
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath()).toCaseFolded();
+}
+
+// --sort, --merge and --split-parts. Returns the exit code.
+int runOperation(const CliOptions& options, const QStringList& inputs, QTextStream& out, QTextStream& err)
+{
+    LE::SortOptions sortOptions;
+    sortOptions.memoryBudget  = options.memoryMiB << 20;
+    sortOptions.tempDir       = options.tempDir;
+    sortOptions.dedup         = options.dedup;
+    sortOptions.presorted     = options.presorted;
+    sortOptions.inputEncoding = options.inputEncoding;
+
+    const auto describe = [](const LE::SortStats& stats) {
+        QString text = QString("%1 entries").arg(stats.records);
+        if (stats.duplicates > 0) text += QString(", %1 duplicates dropped").arg(stats.duplicates);
+        if (stats.runs > 0) text += QString(", %1 runs on disk").arg(stats.runs);
+        return text;
+    };
+
+    if (options.operation == Operation::Merge) {
+        try {
+            const auto stats = LE::PlaylistOps::merge(inputs, options.mergeOutput, sortOptions);
+            out << "Merged " << inputs.size() << " playlists into " << options.mergeOutput
+                << " (" << describe(stats) << ")\n";
+            return 0;
+        } catch (const std::exception& e) {
+            err << "Merge FAILED: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    // Sort and split handle every input on its own, one after another: both
+    // are bound by disk bandwidth, and sorting by the memory budget.
+    const int total = static_cast<int>(inputs.size());
+    int failed = 0;
+    for (int i = 0; i < total; ++i) {
+        const QString& input = inputs[i];
+        try {
+            if (options.operation == Operation::Sort) {
+                const QString output = sortedPathFor(input, options.outputDir);
+                const auto stats = LE::PlaylistOps::sort(input, output, sortOptions);
+                out << '[' << (i + 1) << '/' << total << "] " << input << " -> " << output
+                    << " (" << describe(stats) << ")\n";
+            } else {
+                const QStringList parts = LE::PlaylistOps::split(input, options.partEntries, options.outputDir,
+                                                                 options.inputEncoding);
+                out << '[' << (i + 1) << '/' << total << "] " << input << " -> " << parts.size() << " parts\n";
+            }
+        } catch (const std::exception& e) {
+            err << '[' << (i + 1) << '/' << total << "] FAILED " << input << ": " << e.what() << '\n';
+            ++failed;
+        }
+        out.flush();
+        err.flush();
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("LunateEpsilonCli");
+    app.setApplicationVersion("2.0.0");
+    app.setOrganizationName("LunateEpsilon");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch converter for .m3u / .m3u8 playlists.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("inputs", "Playlist files, directories or globs (e.g. \"D:/Lists/*.m3u\").",
+                                 "<inputs...>");
+
+    const QCommandLineOption baseOpt({"b", "base"},
+        "Base folder path. Required for M3U → M3U8; used by M3U8 → M3U in custom location mode.", "path");
+    const QCommandLineOption locationOpt({"l", "location"},
+        "M3U8 → M3U location mode: keep (default) or custom.", "mode", "keep");
+    const QCommandLineOption outputOpt({"o", "output-dir"},
+        "Directory for converted files. Defaults to the directory of each input.", "dir");
+    const QCommandLineOption jobsOpt({"j", "jobs"},
+        "Number of concurrent conversions. Defaults to the number of CPU cores.", "n");
+    const QCommandLineOption recursiveOpt({"r", "recursive"},
+        "Descend into subdirectories when scanning directories and globs.");
+    const QCommandLineOption splitOpt({"s", "split"},
+        "Also convert each large playlist on all cores by splitting it into chunks.");
+    const QCommandLineOption stripOpt("strip-directives",
+        "Drop #EXTINF and other '#' lines instead of carrying them over.");
+    const QCommandLineOption dedupOpt("dedup",
+        "Drop entries that point to a file listed earlier (same path ignoring case and slash style).");
+    const QCommandLineOption encodingOpt("encoding",
+        "Encoding of playlists without a byte order mark: auto (default; UTF-8, falling back to Windows-1252 "
+        "per line), utf8 or cp1252.", "name", "auto");
+    const QCommandLineOption validateOpt("validate",
+        "Check that converted entries exist: report (list missing files) or drop (also remove them).", "mode");
+    const QCommandLineOption libraryOpt("library-index",
+        "Relink entries that moved within the music library, using this index file. Implies --validate report.", "file");
+    const QCommandLineOption updateIndexOpt("update-index",
+        "Scan this library folder into the --library-index file first (only changed folders are re-read).", "folder");
+    const QCommandLineOption cacheOpt("cache",
+        "Keep converted outputs in this folder and reuse them for inputs that did not change (not with --watch).", "dir");
+    const QCommandLineOption cacheLimitOpt("cache-limit",
+        "Size of the --cache folder in MiB; least recently used outputs are removed first (default 2048).", "MiB");
+    const QCommandLineOption watchOpt({"w", "watch"},
+        "Keep running and reconvert each playlist when it changes; only the changed parts are converted again.");
+    const QCommandLineOption sortOpt("sort",
+        "Instead of converting, sort each playlist by path into <name>.sorted.<ext>.");
+    const QCommandLineOption mergeOpt("merge",
+        "Instead of converting, merge all playlists into this file, sorted by path.", "file");
+    const QCommandLineOption presortedOpt("presorted",
+        "With --merge: the inputs are sorted already and are streamed into the merge.");
+    const QCommandLineOption splitPartsOpt("split-parts",
+        "Instead of converting, cut each playlist into parts of this many entries (<name>.part001.<ext>, …).", "n");
+    const QCommandLineOption memoryOpt("memory",
+        "Memory for --sort and --merge in MiB; larger inputs are sorted through temporary files (default 256).",
+        "MiB");
+    const QCommandLineOption tempDirOpt("temp-dir",
+        "Folder for the temporary files of --sort and --merge. Defaults to the system's.", "dir");
+    const QCommandLineOption perfOpt("perf",
+        "Log where each conversion spends its time and write it to <output>.perf.json.");
+    const QCommandLineOption traceOpt("trace",
+        "Record a Chrome trace of the run into this file, for Perfetto or chrome://tracing.", "file");
+    const QCommandLineOption verboseOpt({"v", "verbose"},
+        "Log every conversion.");
+
+    parser.addOptions({baseOpt, locationOpt, outputOpt, jobsOpt, recursiveOpt, splitOpt, stripOpt, dedupOpt, encodingOpt, validateOpt,
+                       libraryOpt, updateIndexOpt, cacheOpt, cacheLimitOpt, watchOpt, sortOpt, mergeOpt, presortedOpt,
+                       splitPartsOpt, memoryOpt, tempDirOpt, perfOpt, traceOpt, verboseOpt});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    QTextStream out(stdout);
+
+#ifdef LE_DEBUG
+    QLoggingCategory::setFilterRules(
+        "le.converter.debug=true\n"
+        "le.cli.debug=true\n"
+    );
+#else
+    QLoggingCategory::setFilterRules(QString(parser.isSet(verboseOpt)
+        ? "le.*.debug=false\n"
+        : "le.*.debug=false\nle.converter.info=false\n")
+        + (parser.isSet(perfOpt) ? "le.perf.info=true\n" : ""));
+#endif
+
+    // Written when main() returns.
+    const LE::TraceSession trace(parser.value(traceOpt));
+
+    // ── Options ──────────────────────────────────────────────────────────────
+    CliOptions options;
+    options.basePath  = parser.value(baseOpt).trimmed();
+    options.outputDir = parser.value(outputOpt);
+    options.recursive = parser.isSet(recursiveOpt);
+    options.split     = parser.isSet(splitOpt);
+    options.stripDirectives = parser.isSet(stripOpt);
+    options.dedup = parser.isSet(dedupOpt);
+    options.libraryIndex = parser.value(libraryOpt);
+    options.watch = parser.isSet(watchOpt);
+    options.cacheDir = parser.value(cacheOpt);
+    options.perfReport = parser.isSet(perfOpt);
+
+    if (parser.isSet(cacheLimitOpt)) {
+        bool ok = false;
+        options.cacheLimitMiB = parser.value(cacheLimitOpt).toLongLong(&ok);
+        if (!ok || options.cacheLimitMiB < 0) {
+            err << "Invalid cache limit: " << parser.value(cacheLimitOpt) << '\n';
+            return 2;
+        }
+    }
+
+    // Watched playlists are converted by IncrementalConverter, which keeps its
+    // own per-block state and never reads or fills the cache.
+    if (options.watch && !options.cacheDir.isEmpty()) {
+        err << "--cache and --watch cannot be combined.\n";
+        return 2;
+    }
+
+    const int operations = int(parser.isSet(sortOpt)) + int(parser.isSet(mergeOpt)) + int(parser.isSet(splitPartsOpt));
+    if (operations > 1 || (operations == 1 && options.watch)) {
+        err << "--sort, --merge, --split-parts and --watch cannot be combined.\n";
+        return 2;
+    }
+    if (parser.isSet(sortOpt)) {
+        options.operation = Operation::Sort;
+    } else if (parser.isSet(mergeOpt)) {
+        options.operation = Operation::Merge;
+        options.mergeOutput = parser.value(mergeOpt);
+    } else if (parser.isSet(splitPartsOpt)) {
+        options.operation = Operation::Split;
+        bool ok = false;
+        options.partEntries = parser.value(splitPartsOpt).toLongLong(&ok);
+        if (!ok || options.partEntries < 1) {
+            err << "Invalid part size: " << parser.value(splitPartsOpt) << '\n';
+            return 2;
+        }
+    }
+    options.presorted = parser.isSet(presortedOpt);
+    options.tempDir = parser.value(tempDirOpt);
+
+    if (parser.isSet(memoryOpt)) {
+        bool ok = false;
+        options.memoryMiB = parser.value(memoryOpt).toLongLong(&ok);
+        if (!ok || options.memoryMiB < 1) {
+            err << "Invalid memory size: " << parser.value(memoryOpt) << '\n';
+            return 2;
+        }
+    }
+
+    const QString location = parser.value(locationOpt).toLower();
+    if (location == "custom") {
+        options.locationMode = LE::LocationMode::Custom;
+    } else if (location != "keep") {
+        err << "Unknown location mode: " << location << " (expected keep or custom)\n";
+        return 2;
+    }
+
+    const QString encoding = parser.value(encodingOpt).toLower();
+    if (encoding == "utf8" || encoding == "utf-8") {
+        options.inputEncoding = LE::InputEncoding::Utf8;
+    } else if (encoding == "cp1252" || encoding == "windows-1252" || encoding == "latin1") {
+        options.inputEncoding = LE::InputEncoding::Windows1252;
+    } else if (encoding != "auto") {
+        err << "Unknown encoding: " << encoding << " (expected auto, utf8 or cp1252)\n";
+        return 2;
+    }
+
+    if (parser.isSet(validateOpt)) {
+        const QString validation = parser.value(validateOpt).toLower();
+        if (validation == "report") {
+            options.validation = LE::ValidationMode::Report;
+        } else if (validation == "drop") {
+            options.validation = LE::ValidationMode::Drop;
+        } else {
+            err << "Unknown validation mode: " << validation << " (expected report or drop)\n";
+            return 2;
+        }
+    }
+    if (!options.libraryIndex.isEmpty() && options.validation == LE::ValidationMode::Off) {
+        options.validation = LE::ValidationMode::Report;
+    }
+
+    options.jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOpt)) {
+        bool ok = false;
+        options.jobs = parser.value(jobsOpt).toInt(&ok);
+        if (!ok || options.jobs < 1) {
+            err << "Invalid job count: " << parser.value(jobsOpt) << '\n';
+            return 2;
+        }
+    }
+
+    if (!options.outputDir.isEmpty() && !QDir().mkpath(options.outputDir)) {
+        err << "Cannot create output directory: " << options.outputDir << '\n';
+        return 2;
+    }
+
+    // ── Library index ────────────────────────────────────────────────────────
+    if (parser.isSet(updateIndexOpt)) {
+        if (options.libraryIndex.isEmpty()) {
+            err << "--update-index needs --library-index to name the index file.\n";
+            return 2;
+        }
+        try {
+            const auto stats = LE::LibraryIndex::update(parser.value(updateIndexOpt), options.libraryIndex);
+            out << "Indexed " << stats.files << " files in " << stats.directories << " folders ("
+                << stats.directoriesListed << " re-read)\n";
+            out.flush();
+        } catch (const std::exception& e) {
+            err << "Cannot update library index: " << e.what() << '\n';
+            return 1;
+        }
+        if (parser.positionalArguments().isEmpty()) {
+            return 0;
+        }
+    }
+
+    // ── Inputs ───────────────────────────────────────────────────────────────
+    QStringList inputs;
+    for (const QString& arg : parser.positionalArguments()) {
+        inputs << expandInput(arg, options.recursive);
+    }
+    inputs.removeDuplicates();
+
+    if (inputs.isEmpty()) {
+        err << "No playlist files found.\n";
+        parser.showHelp(2);
+    }
+
+    if (options.operation != Operation::Convert) {
+        return runOperation(options, inputs, out, err);
+    }
+
+    const bool needsBase = std::any_of(inputs.cbegin(), inputs.cend(), [](const QString& path) {
+        return path.endsWith(".m3u", Qt::CaseInsensitive);
+    }) || options.locationMode == LE::LocationMode::Custom;
+
+    if (needsBase && options.basePath.isEmpty()) {
+        err << "--base is required for M3U → M3U8 conversion and custom location mode.\n";
+        return 2;
+    }
+
+    // Refuse jobs whose output would overwrite an input of the same batch, or
+    // the output of an earlier job (e.g. dir1/a.m3u and dir2/a.m3u with -o).
+    QSet<QString> inputSet;
+    for (const QString& input : inputs) {
+        inputSet.insert(fileKey(input));
+    }
+    QSet<QString> outputSet;
+
+    std::vector<LE::ConversionParams> jobs;
+    jobs.reserve(inputs.size());
+
+    int rejected = 0;
+    for (const QString& input : inputs) {
+        LE::ConversionParams params;
+        params.inputPath    = input;
+        params.outputPath   = outputPathFor(input, options.outputDir);
+        params.basePath     = options.basePath;
+        params.locationMode = options.locationMode;
+        params.intraFileParallel = options.split;
+        params.keepDirectives = !options.stripDirectives;
+        params.dedup = options.dedup;
+        params.inputEncoding = options.inputEncoding;
+        params.validation = options.validation;
+        params.libraryIndex = options.libraryIndex;
+        params.cacheDir = options.cacheDir;
+        params.perfReport = options.perfReport;
+
+        const QString outputKey = fileKey(params.outputPath);
+        if (inputSet.contains(outputKey)) {
+            err << "Skipping " << input << ": output " << params.outputPath
+                << " is also an input of this batch\n";
+            ++rejected;
+            continue;
+        }
+        if (outputSet.contains(outputKey)) {
+            err << "Skipping " << input << ": output " << params.outputPath
+                << " is also the output of another input of this batch\n";
+            ++rejected;
+            continue;
+        }
+        outputSet.insert(outputKey);
+        jobs.push_back(std::move(params));
+    }
+
+    // ── Run ──────────────────────────────────────────────────────────────────
+    // Bounded pool: at most `jobs` conversions in flight. Each task owns its
+    // Converter, so no state is shared between workers apart from the
+    // per-job error slot it alone writes.
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.jobs);
+
+    std::vector<std::optional<std::string>> errors(jobs.size());
+    std::vector<std::unique_ptr<LE::IncrementalConverter>> watched(jobs.size());
+    std::atomic<int> done{0};
+    std::atomic<int> restored{0};
+    QMutex outputMutex;
+    const int total = static_cast<int>(jobs.size());
+
+    qCInfo(lcCli) << "Converting" << total << "playlists on" << options.jobs << "workers";
+
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        pool.start([&, i]() {
+            qint64 missing = 0;
+            qint64 relinked = 0;
+            qint64 duplicates = 0;
+            bool cached = false;
+            LE::ConversionHooks hooks;
+            hooks.missingEntry = [&](const QString& path) {
+                ++missing;
+                const QMutexLocker lock(&outputMutex);
+                err << "Missing in " << jobs[i].inputPath << ": " << path << '\n';
+            };
+            hooks.progress = [&](const LE::ConversionProgress& progress) {
+                relinked = progress.relinkedEntries;
+                duplicates = progress.duplicateEntries;
+                cached = progress.cached;
+            };
+
+            try {
+                if (options.watch) {
+                    // Same output as Converter, but remembers it for later updates.
+                    auto converter = std::make_unique<LE::IncrementalConverter>(jobs[i]);
+                    converter->update(hooks);
+                    watched[i] = std::move(converter);
+                } else {
+                    LE::Converter converter;
+                    converter.convert(jobs[i], hooks);
+                }
+            } catch (const std::exception& e) {
+                errors[i] = e.what();
+            }
+
+            const int finished = ++done;
+            const QMutexLocker lock(&outputMutex);
+            if (errors[i]) {
+                err << '[' << finished << '/' << total << "] FAILED " << jobs[i].inputPath
+                    << ": " << QString::fromStdString(*errors[i]) << '\n';
+                err.flush();
+            } else {
+                out << '[' << finished << '/' << total << "] " << jobs[i].inputPath
+                    << " -> " << jobs[i].outputPath;
+                if (jobs[i].validation != LE::ValidationMode::Off) {
+                    out << " (" << missing << " missing"
+                        << (jobs[i].validation == LE::ValidationMode::Drop ? ", dropped" : "");
+                    if (!jobs[i].libraryIndex.isEmpty()) {
+                        out << ", " << relinked << " relinked";
+                    }
+                    out << ')';
+                }
+                if (jobs[i].dedup && !cached) {
+                    out << " (" << duplicates << " duplicates dropped)";
+                }
+                if (cached) {
+                    out << " (cached)";
+                    ++restored;
+                }
+                out << '\n';
+                err.flush();
+                out.flush();
+            }
+        });
+    }
+
+    pool.waitForDone();
+
+    if (!options.cacheDir.isEmpty()) {
+        LE::ConversionCache(options.cacheDir).prune(options.cacheLimitMiB << 20);
+    }
+
+    const auto failed = std::count_if(errors.cbegin(), errors.cend(),
+                                      [](const auto& e) { return e.has_value(); });
+
+    out << "Converted " << (total - failed) << " of " << (total + rejected) << " playlists";
+    if (restored > 0) {
+        out << ", " << restored << " from cache";
+    }
+    if (failed + rejected > 0) {
+        out << " (" << failed << " failed, " << rejected << " skipped)";
+    }
+    out << '\n';
+
+    if (!options.watch) {
+        return (failed + rejected) > 0 ? 1 : 0;
+    }
+
+    // ── Watch ────────────────────────────────────────────────────────────────
+    // Runs until interrupted. Playlists that failed above are not watched.
+    LE::PlaylistWatcher watcher;
+    for (auto& converter : watched) {
+        if (converter) watcher.watch(std::move(converter));
+    }
+
+    QObject::connect(&watcher, &LE::PlaylistWatcher::reconverted,
+                     [&](const QString& input, const QString& output, qint64 blocksConverted, qint64 blocks) {
+        out << "Reconverted " << input << " -> " << output << " (" << blocksConverted << " of "
+            << blocks << " blocks)\n";
+        out.flush();
+    });
+    QObject::connect(&watcher, &LE::PlaylistWatcher::failed, [&](const QString& input, const QString& error) {
+        err << "FAILED " << input << ": " << error << '\n';
+        err.flush();
+    });
+
+    out << "Watching " << watcher.size() << " playlists. Press Ctrl+C to stop.\n";
+    out.flush();
+    return app.exec();
+}
@@ -0,0 +1,175 @@
+#include "ConversionCache.h"
+#include "ConversionJob.h"
+#include "LineReader.h"
+#include "Logger.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QUuid>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace LE {
+
+namespace {
+
+// Marks a cached output as recently used, for prune().
+void touch(const QString& path)
+{
+    QFile file(path);
+    if (file.open(QIODevice::Append)) {
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    }
+}
+
+// True if `path` already holds exactly `bytes`.
+bool hasContent(const QString& path, QByteArrayView bytes)
+{
+    if (QFileInfo(path).size() != bytes.size()) {
+        return false;
+    }
+    try {
+        const MappedFile existing(path);
+        return existing.data() == bytes;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+} // namespace
+
+ConversionCache::ConversionCache(const QString& directory)
+    : m_directory(directory)
+{}
+
+// Everything that reaches the output: the direction (input extension), base
+// path, location mode, directives, dedup, input encoding, the output name (it appears in a generated
+// #EXTM3U header) and the platform's line endings.
+QByteArray ConversionCache::key(const ConversionParams& params, QByteArrayView input)
+{
+    QByteArray shape;
+    const auto field = [&](QByteArrayView value) {
+        shape += value;
+        shape += '\0';
+    };
+
+    field("LunateEpsilon/" + QByteArray::number(kFormatVersion));
+    field(QFileInfo(params.inputPath).suffix().toLower().toUtf8());
+    field(params.basePath.toUtf8());
+    field(QByteArray::number(static_cast<int>(params.locationMode)));
+    field(QByteArray::number(params.keepDirectives));
+    field(QByteArray::number(params.dedup));
+    field(QByteArray::number(static_cast<int>(params.inputEncoding)));
+    field(QFileInfo(params.outputPath).completeBaseName().toUtf8());
+#ifdef Q_OS_WIN
+    field("crlf");
+#else
+    field("lf");
+#endif
+
+    QCryptographicHash hash(QCryptographicHash::Blake2b_256);
+    hash.addData(shape);
+    hash.addData(input);
+    return hash.result().toHex();
+}
+
+bool ConversionCache::restore(const QByteArray& key, const QString& outputPath) const
+{
+    const QString object = objectPath(key);
+    if (!QFileInfo::exists(object)) {
+        return false;
+    }
+
+    std::optional<MappedFile> cached;
+    try {
+        cached.emplace(object);
+    } catch (const std::exception&) {
+        return false;   // Pruned by another process in the meantime
+    }
+
+    // Leave an identical output alone, so its timestamp does not change either.
+    if (!hasContent(outputPath, cached->data())) {
+        QSaveFile out(outputPath);
+        openOutput(out);
+        if (out.write(cached->data().data(), cached->size()) != cached->size()) {
+            throw std::runtime_error("Cannot write output file: " + outputPath.toStdString()
+                                     + " (" + out.errorString().toStdString() + ")");
+        }
+        commitOutput(out);
+    }
+
+    cached.reset();
+    touch(object);
+    return true;
+}
+
+void ConversionCache::store(const QByteArray& key, const QString& outputPath) const
+{
+    const QString object = objectPath(key);
+    if (QFileInfo::exists(object)) {
+        return;
+    }
+
+    // Copy next to the object and rename, so readers never see a partial one.
+    // Two jobs with the same output may race here; the loser's rename fails.
+    const QString directory = QFileInfo(object).absolutePath();
+    const QString temporary = object + u'.' + QUuid::createUuid().toString(QUuid::Id128);
+    if (!QDir().mkpath(directory) || !QFile::copy(outputPath, temporary)) {
+        qCWarning(lcConverter) << "Cannot store output in the conversion cache:" << object;
+        return;
+    }
+    if (!QFile::rename(temporary, object)) {
+        QFile::remove(temporary);
+    }
+}
+
+qint64 ConversionCache::prune(qint64 maxBytes) const
+{
+    struct Object {
+        QString   path;
+        qint64    size;
+        QDateTime used;
+    };
+
+    std::vector<Object> objects;
+    qint64 total = 0;
+
+    QDirIterator it(m_directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        objects.push_back({info.absoluteFilePath(), info.size(), info.lastModified()});
+        total += info.size();
+    }
+
+    std::sort(objects.begin(), objects.end(),
+              [](const Object& a, const Object& b) { return a.used < b.used; });
+
+    qint64 freed = 0;
+    for (const Object& object : objects) {
+        if (total - freed <= maxBytes) break;
+        if (QFile::remove(object.path)) {
+            freed += object.size;
+        }
+    }
+
+    qCDebug(lcConverter) << "Conversion cache:" << total << "bytes," << freed << "pruned";
+    return freed;
+}
+
+// Two-level fan-out keeps directories small: <dir>/ab/cdef…
+QString ConversionCache::objectPath(const QByteArray& key) const
+{
+    return QDir(m_directory).filePath(QString::fromLatin1(key.first(2)) + u'/' + QString::fromLatin1(key.sliced(2)));
+}
+
+} // namespace LE
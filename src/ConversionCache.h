@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Converter.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+namespace LE {
+
+// Content-addressed store of conversion outputs (ConversionParams::cacheDir).
+//
+// An output is filed under a BLAKE2b hash of the input bytes and every
+// parameter that shapes the output. Converting an input that was converted
+// before with the same parameters is then a hash of the input plus a copy of
+// the stored output, or nothing at all if the output file is still identical.
+//
+// Outputs that depend on the file system (validation) are never cached.
+// The store only grows; prune() trims it to a size budget, least recently
+// used first. Any part of it can be deleted at any time.
+// Safe to use from several threads and processes at once.
+class ConversionCache {
+public:
+    // Bump whenever a change to the conversion rules changes output bytes.
+    static constexpr int kFormatVersion = 2;
+
+    explicit ConversionCache(const QString& directory);
+
+    [[nodiscard]] static bool isCacheable(const ConversionParams& params) noexcept
+    {
+        return params.validation == ValidationMode::Off;
+    }
+
+    // Hex key of converting `input` with `params`.
+    [[nodiscard]] static QByteArray key(const ConversionParams& params, QByteArrayView input);
+
+    // Makes `outputPath` hold the output stored under `key`. Returns false on
+    // a cache miss. Throws std::runtime_error if the output cannot be written.
+    bool restore(const QByteArray& key, const QString& outputPath) const;
+
+    // Stores a finished output under `key`. Failures are logged, not thrown:
+    // the conversion itself succeeded.
+    void store(const QByteArray& key, const QString& outputPath) const;
+
+    // Deletes the least recently used outputs until the store fits in
+    // `maxBytes`. Returns the number of bytes freed.
+    qint64 prune(qint64 maxBytes) const;
+
+private:
+    [[nodiscard]] QString objectPath(const QByteArray& key) const;
+
+    QString m_directory;
+};
+
+} // namespace LE
@@ -0,0 +1,155 @@
+#include "ConversionJob.h"
+#include "EntryTransforms.h"
+#include "LineReader.h"
+#include "OutputWriter.h"
+#include "Playlist.h"
+#include "Logger.h"
+
+#include <QFileInfo>
+
+#include <stdexcept>
+
+namespace LE {
+
+namespace {
+
+// M3U → M3U8: library-relative entries become absolute under the base folder
+// (the base itself is the pipeline's output prefix).
+using M3uToM3u8Kernel = EntryKernel<StripMusicPrefix, NormalizeSeparators>;
+
+// M3U8 → M3U: entries are normalized and, in custom mode, reduced to their file
+// name so that the output prefix moves them to the custom folder.
+using M3u8ToM3uKeepKernel   = EntryKernel<NormalizeSeparators>;
+using M3u8ToM3uCustomKernel = EntryKernel<NormalizeSeparators, KeepFileName>;
+
+bool isM3uInput(const QString& inputPath)
+{
+    return inputPath.endsWith(".m3u", Qt::CaseInsensitive);
+}
+
+// The only place a conversion branches on its direction and location mode.
+TransformKernel kernelFor(const ConversionParams& params)
+{
+    if (isM3uInput(params.inputPath)) {
+        return TransformKernel::of<M3uToM3u8Kernel>();
+    }
+    if (params.locationMode == LocationMode::Custom) {
+        return TransformKernel::of<M3u8ToM3uCustomKernel>();
+    }
+    return TransformKernel::of<M3u8ToM3uKeepKernel>();
+}
+
+// True if the first non-blank line of the input is an #EXTM3U header, which
+// is then carried over instead of a generated one.
+bool hasExtM3uHeader(QByteArrayView data, InputEncoding encoding)
+{
+    LineReader reader(data);
+    LineCleaner cleaner(encoding);
+
+    QByteArrayView raw;
+    while (reader.next(raw)) {
+        const QByteArrayView line = cleaner.clean(raw);
+        if (!line.isEmpty()) {
+            return line.startsWith("#EXTM3U");
+        }
+    }
+    return false;
+}
+
+void writeM3u8Header(MemorySink& out, const QString& outputPath)
+{
+    const QString outputName = QFileInfo(outputPath).completeBaseName();
+
+    out.appendUtf8("#EXTM3U");
+    out.endLine();
+    out.append('#');
+    out.append(outputName);
+    out.appendUtf8(".m3u8");
+    out.endLine();
+}
+
+} // namespace
+
+ConversionJob::ConversionJob(const ConversionParams& params)
+    : m_params(params)
+    , m_kernel(kernelFor(params))
+{
+    if (!params.inputPath.endsWith(".m3u", Qt::CaseInsensitive) &&
+        !params.inputPath.endsWith(".m3u8", Qt::CaseInsensitive))
+    {
+        throw std::runtime_error("Unsupported file type. Expected .m3u or .m3u8.");
+    }
+
+    m_toM3u8 = isM3uInput(params.inputPath);
+
+    // ── Output prefix: "<base>\" in front of every entry, if any ────────────
+    if (m_toM3u8 || params.locationMode == LocationMode::Custom) {
+        if (params.basePath.isEmpty()) {
+            throw std::runtime_error(m_toM3u8 ? "Base path is required for M3U → M3U8 conversion."
+                                              : "Custom base path is required for custom location mode.");
+        }
+        m_options.outputPrefix = Converter::normalizePath(params.basePath) + u'\\';
+    }
+
+    m_options.keepDirectives = params.keepDirectives;
+    m_options.inputEncoding  = params.inputEncoding;
+    m_options.dedup          = params.dedup;
+    m_options.validation     = params.validation;
+
+    if (params.validation != ValidationMode::Off) {
+        m_validator.emplace(QFileInfo(params.outputPath).absolutePath());
+        m_options.validator = &*m_validator;
+
+        if (!params.libraryIndex.isEmpty()) {
+            m_library.emplace(params.libraryIndex);
+            m_options.library = &*m_library;
+        }
+    }
+}
+
+QByteArrayView ConversionJob::prepareInput(QByteArrayView raw)
+{
+    m_options.inputEncoding = m_params.inputEncoding;
+    return Encoding::prepare(raw, m_options.inputEncoding, m_transcoded);
+}
+
+QByteArray ConversionJob::header(QByteArrayView input) const
+{
+    MemorySink out;
+    if (m_toM3u8 && !(m_params.keepDirectives && hasExtM3uHeader(input, m_options.inputEncoding))) {
+        writeM3u8Header(out, m_params.outputPath);
+    }
+    return out.bytes();
+}
+
+void ConversionJob::logSummary(const JobMonitor& monitor) const
+{
+    if (m_params.dedup) {
+        qCInfo(lcConverter) << "Deduplication:" << monitor.duplicateEntries() << "duplicate entries dropped";
+    }
+    if (m_validator) {
+        qCInfo(lcConverter) << "Validation:" << monitor.missingEntries() << "missing entries,"
+                            << monitor.relinkedEntries() << "relinked,"
+                            << m_validator->directoriesListed() << "directories listed";
+    }
+}
+
+// OutputWriter does its own buffering and line-ending translation.
+void openOutput(QSaveFile& file)
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        qCCritical(lcConverter) << "Failed to open output file:" << file.fileName();
+        throw std::runtime_error("Cannot open output file: " + file.fileName().toStdString());
+    }
+}
+
+void commitOutput(QSaveFile& file)
+{
+    if (!file.commit()) {
+        qCCritical(lcConverter) << "Failed to commit output file:" << file.fileName() << file.errorString();
+        throw std::runtime_error("Cannot write output file: " + file.fileName().toStdString()
+                                 + " (" + file.errorString().toStdString() + ")");
+    }
+}
+
+} // namespace LE
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Converter.h"
+#include "LibraryIndex.h"
+#include "PathValidator.h"
+#include "Pipeline.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSaveFile>
+
+#include <optional>
+
+namespace LE {
+
+// Everything about a conversion that follows from its ConversionParams alone:
+// direction, transform kernel, output prefix, header and validation. Shared by
+// Converter and IncrementalConverter so that both produce the same bytes.
+// Throws std::runtime_error for an unsupported input or a missing base path.
+class ConversionJob {
+public:
+    explicit ConversionJob(const ConversionParams& params);
+
+    ConversionJob(const ConversionJob&) = delete;
+    ConversionJob& operator=(const ConversionJob&) = delete;
+
+    [[nodiscard]] bool toM3u8() const noexcept { return m_toM3u8; }
+
+    // Settles the encoding of an input from its byte order mark and returns
+    // the bytes to convert: `raw` itself, or its UTF-8 transcoding for UTF-16
+    // input (valid as long as the job is). Call once per input, before
+    // pipeline() and header().
+    [[nodiscard]] QByteArrayView prepareInput(QByteArrayView raw);
+
+    [[nodiscard]] InputEncoding inputEncoding() const noexcept { return m_options.inputEncoding; }
+
+    // Valid as long as the job is.
+    [[nodiscard]] Pipeline pipeline() const { return Pipeline(m_kernel, m_options); }
+
+    // Lines written before the converted input: a generated #EXTM3U header
+    // for M3U8 output, unless the input carries its own. UTF-8, with the
+    // output's line endings.
+    [[nodiscard]] QByteArray header(QByteArrayView input) const;
+
+    // Logs the dedup and validation summaries of the stages that ran.
+    void logSummary(const JobMonitor& monitor) const;
+
+private:
+    ConversionParams             m_params;
+    bool                         m_toM3u8 = false;
+    TransformKernel              m_kernel;
+    PipelineOptions              m_options;
+    std::optional<PathValidator> m_validator;
+    std::optional<LibraryIndex>  m_library;
+    QByteArray                   m_transcoded;
+};
+
+// Output files are written to a temporary file and renamed over the target
+// by commitOutput(); without a commit, QSaveFile discards the temporary file.
+// Both throw std::runtime_error on failure.
+void openOutput(QSaveFile& file);
+void commitOutput(QSaveFile& file);
+
+} // namespace LE
@@ -0,0 +1,278 @@
+#include "ConversionQueue.h"
+#include "Logger.h"
+#include "Tracer.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMetaObject>
+
+#include <algorithm>
+#include <exception>
+
+Q_LOGGING_CATEGORY(lcQueue, "le.queue")
+
+namespace LE {
+
+ConversionQueue::ConversionQueue(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    m_pool.setObjectName("ConversionQueue");
+}
+
+ConversionQueue::~ConversionQueue()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+void ConversionQueue::setMaxThreads(int threads)
+{
+    m_pool.setMaxThreadCount(std::max(threads, 1));
+    qCInfo(lcQueue) << "Conversion workers:" << m_pool.maxThreadCount();
+}
+
+QString ConversionQueue::pathKey(const QString& path)
+{
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath()).toCaseFolded();
+}
+
+bool ConversionQueue::enqueue(const ConversionParams& params)
+{
+    const TraceSpan span("enqueue", params.inputPath);
+    const QString outputKey = pathKey(params.outputPath);
+    if (m_activeOutputs.contains(outputKey)) {
+        qCWarning(lcQueue) << "Not queued, output already being written:" << params.outputPath;
+        return false;
+    }
+
+    if (m_active == 0) {
+        clearFinished();
+        m_batchClock.start();
+    }
+
+    Job job;
+    job.id       = m_nextId++;
+    job.params   = params;
+    job.canceled = std::make_shared<std::atomic<bool>>(false);
+    job.queuedAt = Tracer::isEnabled() ? Tracer::now() : -1;
+    job.outputKey = outputKey;
+
+    const int row = rowCount();
+    beginInsertRows({}, row, row);
+    m_jobs.push_back(job);
+    endInsertRows();
+
+    ++m_active;
+    m_activeOutputs.insert(outputKey);
+    start(job);
+    emit progressChanged();
+    return true;
+}
+
+void ConversionQueue::cancelAll()
+{
+    for (const Job& job : m_jobs) {
+        if (job.status == Status::Queued || job.status == Status::Running) {
+            job.canceled->store(true);
+        }
+    }
+}
+
+void ConversionQueue::clearFinished()
+{
+    if (isBusy() || m_jobs.empty()) {
+        return;
+    }
+    beginResetModel();
+    m_jobs.clear();
+    m_firstId = m_nextId;
+    endResetModel();
+}
+
+// Runs on a pool thread. The job is copied: only the queue's thread may
+// change m_jobs, and only through the posted updates.
+void ConversionQueue::start(const Job& job)
+{
+    m_pool.start([this, id = job.id, params = job.params, canceled = job.canceled, queuedAt = job.queuedAt]() {
+        // Time spent waiting for a worker, drawn on the worker that took the job.
+        if (queuedAt >= 0) {
+            Tracer::record("queued", queuedAt, Tracer::now(), params.inputPath);
+        }
+        const TraceSpan span("job", params.inputPath);
+
+        const auto post = [this](auto update) {
+            QMetaObject::invokeMethod(this, std::move(update), Qt::QueuedConnection);
+        };
+
+        if (canceled->load()) {
+            post([this, id] { onFinished(id, Status::Canceled, {}); });
+            return;
+        }
+        post([this, id] { onStarted(id); });
+
+        // Progress arrives at most once per ConversionHooks::kProgressIntervalMs.
+        ConversionHooks hooks;
+        hooks.isCanceled = [canceled] { return canceled->load(); };
+        hooks.progress = [&post, this, id](const ConversionProgress& progress) {
+            post([this, id, progress] { onProgress(id, progress); });
+        };
+
+        Status status = Status::Done;
+        QString error;
+        try {
+            Converter converter;
+            converter.convert(params, hooks);
+        } catch (const ConversionCanceled&) {
+            status = Status::Canceled;
+        } catch (const std::exception& e) {
+            status = Status::Failed;
+            error = QString::fromStdString(e.what());
+        }
+        post([this, id, status, error] { onFinished(id, status, error); });
+    });
+}
+
+void ConversionQueue::onStarted(quint64 id)
+{
+    const int row = rowOf(id);
+    if (row < 0) return;
+
+    m_jobs[static_cast<std::size_t>(row)].status = Status::Running;
+    emit dataChanged(index(row), index(row));
+}
+
+void ConversionQueue::onProgress(quint64 id, const ConversionProgress& progress)
+{
+    const int row = rowOf(id);
+    if (row < 0) return;
+
+    Job& job = m_jobs[static_cast<std::size_t>(row)];
+    job.progress = progress.bytesTotal > 0
+        ? static_cast<int>(progress.bytesDone * kProgressSteps / progress.bytesTotal)
+        : kProgressSteps;
+    job.bytesDone = progress.bytesDone;
+    job.linesDone = progress.linesDone;
+    job.cached    = progress.cached;
+    emit dataChanged(index(row), index(row));
+    emit progressChanged();
+}
+
+void ConversionQueue::onFinished(quint64 id, Status status, const QString& error)
+{
+    const TraceSpan span("job finished");
+    const int row = rowOf(id);
+    if (row < 0) return;
+
+    Job& job = m_jobs[static_cast<std::size_t>(row)];
+    job.status   = status;
+    job.error    = error;
+    job.progress = kProgressSteps;
+    emit dataChanged(index(row), index(row));
+
+    if (status == Status::Failed) {
+        qCWarning(lcQueue) << "Conversion failed:" << job.params.inputPath << error;
+    }
+
+    --m_active;
+    m_activeOutputs.remove(job.outputKey);
+    emit progressChanged();
+    if (m_active == 0) {
+        qCInfo(lcQueue) << "Queue drained";
+        emit drained();
+    }
+}
+
+ConversionQueue::BatchStats ConversionQueue::batchStats() const
+{
+    BatchStats stats;
+    stats.elapsedMs = m_batchClock.isValid() ? m_batchClock.elapsed() : 0;
+    for (const Job& job : m_jobs) {
+        ++stats.total;
+        if (!job.cached) {
+            stats.bytesDone += job.bytesDone;
+            stats.linesDone += job.linesDone;
+        }
+        switch (job.status) {
+            case Status::Queued:
+            case Status::Running:  break;
+            case Status::Done:     ++stats.finished; break;
+            case Status::Failed:   ++stats.finished; ++stats.failed; break;
+            case Status::Canceled: ++stats.finished; ++stats.canceled; break;
+        }
+    }
+    return stats;
+}
+
+int ConversionQueue::batchProgress() const
+{
+    if (m_jobs.empty()) {
+        return 0;
+    }
+
+    qint64 sum = 0;
+    for (const Job& job : m_jobs) {
+        sum += job.progress;
+    }
+    return static_cast<int>(sum / static_cast<qint64>(m_jobs.size()));
+}
+
+QStringList ConversionQueue::batchErrors() const
+{
+    QStringList errors;
+    for (const Job& job : m_jobs) {
+        if (job.status == Status::Failed) {
+            errors << QFileInfo(job.params.inputPath).fileName() + ": " + job.error;
+        }
+    }
+    return errors;
+}
+
+int ConversionQueue::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_jobs.size());
+}
+
+QVariant ConversionQueue::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return {};
+    }
+    const Job& job = m_jobs[static_cast<std::size_t>(index.row())];
+
+    switch (role) {
+        case Qt::DisplayRole:
+            return QFileInfo(job.params.inputPath).fileName() + u"  →  "
+                 + QFileInfo(job.params.outputPath).fileName() + u"    " + statusText(job);
+        case Qt::ToolTipRole:
+            return job.params.inputPath + u'\n' + job.params.outputPath
+                 + (job.error.isEmpty() ? QString() : u'\n' + job.error);
+        default:
+            return {};
+    }
+}
+
+// Ids are handed out in row order and rows are only ever removed all at
+// once, so a job's row follows from its id.
+int ConversionQueue::rowOf(quint64 id) const
+{
+    if (id < m_firstId || id - m_firstId >= m_jobs.size()) {
+        return -1;
+    }
+    const auto row = static_cast<std::size_t>(id - m_firstId);
+    Q_ASSERT(m_jobs[row].id == id);
+    return static_cast<int>(row);
+}
+
+QString ConversionQueue::statusText(const Job& job) const
+{
+    switch (job.status) {
+        case Status::Queued:   return "Queued";
+        case Status::Running:  return QString("%1%").arg(job.progress / 10);
+        case Status::Done:     return job.cached ? "Done (cached)" : "Done";
+        case Status::Failed:   return "Failed: " + job.error;
+        case Status::Canceled: return "Canceled";
+    }
+    return {};
+}
+
+} // namespace LE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Converter.h"
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace LE {
+
+// Conversions queued from the main window, run concurrently on a thread pool
+// of their own, so that a long queue never starves the chunked pipeline and
+// the other users of the global pool.
+//
+// Each job carries its own status, progress and error. Workers never touch
+// a job directly: they post their updates to the queue's thread, which owns
+// all job state, so the model can be read without locking. Rows are the jobs
+// of the current batch, in the order they were queued: a batch is every job
+// queued since the queue was last idle, and the first job of the next batch
+// clears the rows of the one before.
+class ConversionQueue : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum class Status {
+        Queued,
+        Running,
+        Done,
+        Failed,
+        Canceled
+    };
+
+    struct BatchStats {
+        int total    = 0;
+        int finished = 0;   // Including failed and canceled
+        int failed   = 0;
+        int canceled = 0;
+
+        // Input converted by the jobs of the batch so far, outputs restored
+        // from the cache left out, and the time since the batch started.
+        qint64 bytesDone = 0;
+        qint64 linesDone = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    static constexpr int kProgressSteps = 1000;
+
+    explicit ConversionQueue(QObject* parent = nullptr);
+
+    // Cancels every job and waits for the running ones to stop.
+    ~ConversionQueue() override;
+
+    [[nodiscard]] int maxThreads() const { return m_pool.maxThreadCount(); }
+    void setMaxThreads(int threads);
+
+    // Returns false, queuing nothing, if a queued or running job already
+    // writes params.outputPath: two jobs would race on one file.
+    [[nodiscard]] bool enqueue(const ConversionParams& params);
+
+    // Identity of a file as Windows sees it: absolute, cleaned and
+    // case-folded, so "A.m3u8" and "./a.M3U8" are the same output.
+    [[nodiscard]] static QString pathKey(const QString& path);
+
+    // Running jobs stop at their next checkpoint; queued ones never start.
+    // Outputs of canceled jobs are left as they were.
+    void cancelAll();
+
+    [[nodiscard]] bool isBusy() const noexcept { return m_active > 0; }
+    [[nodiscard]] BatchStats batchStats() const;
+
+    // Progress of the current batch, in per mille.
+    [[nodiscard]] int batchProgress() const;
+
+    // Failure messages of the current batch, one "file: error" per job.
+    [[nodiscard]] QStringList batchErrors() const;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+signals:
+    void progressChanged();
+    void drained();     // The last job of the batch finished
+
+private:
+    struct Job {
+        quint64          id = 0;
+        ConversionParams params;
+        Status           status   = Status::Queued;
+        int              progress = 0;
+        qint64           bytesDone = 0;
+        qint64           linesDone = 0;
+        bool             cached   = false;
+        QString          error;
+        QString          outputKey;         // pathKey(params.outputPath)
+        qint64           queuedAt = -1;     // Tracer::now() when traced
+        std::shared_ptr<std::atomic<bool>> canceled;
+    };
+
+    // Removes the rows of the previous batch. Only while the queue is idle.
+    void clearFinished();
+
+    void start(const Job& job);
+
+    // Updates posted by the workers.
+    void onStarted(quint64 id);
+    void onProgress(quint64 id, const ConversionProgress& progress);
+    void onFinished(quint64 id, Status status, const QString& error);
+
+    [[nodiscard]] int rowOf(quint64 id) const;
+    [[nodiscard]] QString statusText(const Job& job) const;
+
+    std::vector<Job> m_jobs;
+    QElapsedTimer    m_batchClock;
+    quint64          m_nextId = 1;
+    quint64          m_firstId = 1;     // Id of the job in row 0
+    QSet<QString>    m_activeOutputs;   // Output keys of the queued and running jobs
+    int              m_active = 0;      // Jobs queued or running
+    QThreadPool      m_pool;
+};
+
+} // namespace LE
@@ -1,128 +1,131 @@
 #include "Converter.h"
+#include "ConversionCache.h"
+#include "ConversionJob.h"
+#include "LineReader.h"
+#include "OutputWriter.h"
+#include "PathKernels.h"
+#include "Pipeline.h"
+#include "Tracer.h"
 #include "Logger.h"
-#include <QFile>
-#include <QTextStream>
-#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QThread>
+
+#include <optional>
 
 Q_LOGGING_CATEGORY(lcConverter, "le.converter")
 
 namespace LE {
 
-void Converter::convert(const ConversionParams& params)
-{
-    qCInfo(lcConverter) << "Conversion start:" << params.inputPath << "->" << params.outputPath;
+namespace {
 
-    if (!params.inputPath.endsWith(".m3u", Qt::CaseInsensitive) &&
-        !params.inputPath.endsWith(".m3u8", Qt::CaseInsensitive))
+// Diagnostics only: a report that cannot be written does not fail the
+// conversion it describes.
+void writePerfReport(const ConversionParams& params, const PerfCounters& counters)
+{
+    QJsonObject report = counters.toJson();
+    report.insert("input", params.inputPath);
+    report.insert("output", params.outputPath);
+    report.insert("threads", QThread::idealThreadCount());
+
+    const QString path = params.outputPath + ".perf.json";
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(report).toJson()) < 0 ||
+        !file.commit())
     {
-        throw std::runtime_error("Unsupported file type. Expected .m3u or .m3u8.");
+        qCWarning(lcPerf) << "Cannot write performance report:" << path << file.errorString();
     }
-
-    if (params.inputPath.endsWith(".m3u", Qt::CaseInsensitive)) {
-        convertM3uToM3u8(params);
-    } else {
-        convertM3u8ToM3u(params);
-    }
-
-    qCInfo(lcConverter) << "Conversion complete:" << params.outputPath;
 }
 
-// ─── M3U → M3U8 ────────────────────────────────────────────────────────────
+} // namespace
 
-void Converter::convertM3uToM3u8(const ConversionParams& params)
+void Converter::convert(const ConversionParams& params, const ConversionHooks& hooks)
 {
-    if (params.basePath.isEmpty()) {
-        throw std::runtime_error("Base path is required for M3U → M3U8 conversion.");
-    }
-
-    const QString base = normalizePath(params.basePath);
-    const QString outputName = QFileInfo(params.outputPath).completeBaseName();
-
-    QFile inFile(params.inputPath);
-    if (!inFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCCritical(lcConverter) << "Failed to open input file:" << params.inputPath;
-        throw std::runtime_error("Cannot open input file: " + params.inputPath.toStdString());
-    }
-
-    QFile outFile(params.outputPath);
-    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-        qCCritical(lcConverter) << "Failed to open output file:" << params.outputPath;
-        throw std::runtime_error("Cannot open output file: " + params.outputPath.toStdString());
-    }
-
-    QTextStream in(&inFile);
-    QTextStream out(&outFile);
-    in.setEncoding(QStringConverter::Utf8);
-    out.setEncoding(QStringConverter::Utf8);
-
-    out << "#EXTM3U\n";
-    out << "#" << outputName << ".m3u8\n";
-
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-
-        if (line.isEmpty() || line.startsWith('#')) {
-            continue;
+    qCInfo(lcConverter) << "Conversion start:" << params.inputPath << "->" << params.outputPath;
+    qCDebug(lcConverter) << "Path kernel:" << PathKernels::activeKernelName();
+
+    const TraceSpan span("convert", params.inputPath);
+    ConversionJob job(params);
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    // Each phase is traced from its emplace() to the next one.
+    std::optional<TraceSpan> phase;
+
+    // ── Shared read → transform → write ──────────────────────────────────────
+    phase.emplace("map input");
+    const MappedFile input(params.inputPath);
+
+    std::optional<ConversionCache> cache;
+    QByteArray cacheKey;
+    if (!params.cacheDir.isEmpty() && ConversionCache::isCacheable(params)) {
+        phase.emplace("cache lookup");
+        cache.emplace(params.cacheDir);
+        cacheKey = ConversionCache::key(params, input.data());
+
+        if (cache->restore(cacheKey, params.outputPath)) {
+            if (hooks.progress) {
+                ConversionProgress progress;
+                progress.bytesDone = progress.bytesTotal = input.size();
+                progress.cached = true;
+                hooks.progress(progress);
+            }
+            qCInfo(lcConverter) << "Conversion restored from cache:" << params.outputPath;
+            return;
         }
-
-        line = stripLeadingMusicPrefix(line);
-        line = normalizePath(line);
-
-        const QString fullPath = base + '\\' + line;
-        out << fullPath << '\n';
     }
 
-    qCDebug(lcConverter) << "M3U→M3U8 written to:" << params.outputPath;
-}
-
-// ─── M3U8 → M3U ────────────────────────────────────────────────────────────
+    phase.emplace("prepare input");
+    const QByteArrayView data = job.prepareInput(input.data());
 
-void Converter::convertM3u8ToM3u(const ConversionParams& params)
-{
-    QString customBase;
+    phase.emplace("open output");
+    QSaveFile outFile(params.outputPath);
+    openOutput(outFile);
+    OutputWriter out(outFile);
 
-    if (params.locationMode == LocationMode::Custom) {
-        if (params.basePath.isEmpty()) {
-            throw std::runtime_error("Custom base path is required for custom location mode.");
-        }
-        customBase = normalizePath(params.basePath);
-    }
+    out.appendUtf8(job.header(data));
 
-    QFile inFile(params.inputPath);
-    if (!inFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCCritical(lcConverter) << "Failed to open input file:" << params.inputPath;
-        throw std::runtime_error("Cannot open input file: " + params.inputPath.toStdString());
-    }
+    const auto execution = Pipeline::chooseExecution(data.size(), params.intraFileParallel);
+    qCDebug(lcConverter) << "Pipeline execution:" << Pipeline::executionName(execution);
 
-    QFile outFile(params.outputPath);
-    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-        qCCritical(lcConverter) << "Failed to open output file:" << params.outputPath;
-        throw std::runtime_error("Cannot open output file: " + params.outputPath.toStdString());
+    JobMonitor monitor(hooks, data.size());
+    if (params.perfReport || lcPerf().isInfoEnabled()) {
+        monitor.enablePerf();
     }
-
-    QTextStream in(&inFile);
-    QTextStream out(&outFile);
-    in.setEncoding(QStringConverter::Utf8);
-    out.setEncoding(QStringConverter::Utf8);
-
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-
-        if (line.isEmpty() || line.startsWith('#')) {
-            continue;
+    phase.emplace("pipeline");
+    job.pipeline().run(data, out, monitor, execution);
+    job.logSummary(monitor);
+
+    phase.emplace("finish output");
+    out.finish();
+
+    phase.emplace("commit");
+    QElapsedTimer commitClock;
+    commitClock.start();
+    commitOutput(outFile);
+    phase.reset();
+
+    if (PerfCounters* perf = monitor.perf()) {
+        perf->execution = Pipeline::executionName(execution);
+        perf->bytesIn   = input.size();
+        perf->bytesOut  = out.bytesWritten();
+        perf->deviceNs  = out.deviceNanoseconds() + commitClock.nsecsElapsed();
+        perf->wallNs    = wallClock.nsecsElapsed();
+        perf->log(params.outputPath);
+        if (params.perfReport) {
+            writePerfReport(params, *perf);
         }
+    }
 
-        const QString originalPath = normalizePath(line);
-
-        if (params.locationMode == LocationMode::Keep) {
-            out << originalPath << '\n';
-        } else {
-            const QString filename = QFileInfo(originalPath).fileName();
-            out << customBase << '\\' << filename << '\n';
-        }
+    if (cache) {
+        const TraceSpan storeSpan("cache store");
+        cache->store(cacheKey, params.outputPath);
     }
 
-    qCDebug(lcConverter) << "M3U8→M3U written to:" << params.outputPath;
+    qCInfo(lcConverter) << "Conversion complete:" << params.outputPath;
 }
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
@@ -132,37 +135,73 @@ void Converter::convertM3u8ToM3u(const ConversionParams& params)
 QString Converter::normalizePath(const QString& path)
 {
     QString result;
-    result.reserve(path.size());
+    normalizePathInto(path, result);
+    return result;
+}
 
-    bool lastWasSep = false;
+// Appends the normalized form of `path` to `out`.
+// The work is done by the vectorized kernel in PathKernels directly inside
+// `out`'s storage; see PathKernels::collapseSeparatorsScalar for the reference.
+void Converter::normalizePathInto(QStringView path, QString& out)
+{
+    const qsizetype start = out.size();
+    out.resize(start + path.size());
 
-    for (const QChar ch : path) {
-        if (ch == '/' || ch == '\\') {
-            if (!lastWasSep) {
-                result.append('\\');
-            }
-            lastWasSep = true;
-        } else {
-            result.append(ch);
-            lastWasSep = false;
-        }
-    }
+    const qsizetype written = PathKernels::collapseSeparators(
+        path.utf16(), path.size(), reinterpret_cast<char16_t*>(out.data()) + start);
+
+    out.resize(start + written);
+}
 
-    // Strip trailing backslash
-    while (result.endsWith('\\')) {
-        result.chop(1);
+QStringView Converter::stripLeadingMusicPrefix(QStringView line)
+{
+    constexpr QLatin1StringView prefix{"Music/"};
+    if (line.startsWith(prefix)) {
+        return line.sliced(prefix.size());
     }
+    return line;
+}
 
-    return result;
+// File name component of a normalized path, with the same Windows semantics as
+// QFileInfo::fileName(): text after the last separator, or after a bare drive
+// specifier ("C:track.mp3").
+QStringView Converter::fileNameOf(QStringView path)
+{
+    const qsizetype lastSep = path.lastIndexOf(u'\\');
+    if (lastSep < 0 && path.size() >= 2 && path[1] == u':') {
+        return path.sliced(2);
+    }
+    return path.sliced(lastSep + 1);
 }
 
-QString Converter::stripLeadingMusicPrefix(const QString& line)
+// ─── UTF-8 variants ──────────────────────────────────────────────────────────
+
+QByteArrayView Converter::stripLeadingMusicPrefix(QByteArrayView line)
 {
-    constexpr QLatin1StringView prefix{"Music/"};
+    constexpr QByteArrayView prefix{"Music/"};
     if (line.startsWith(prefix)) {
         return line.sliced(prefix.size());
     }
     return line;
 }
 
+void Converter::normalizePathInto(QByteArrayView path, QByteArray& out)
+{
+    const qsizetype start = out.size();
+    out.resize(start + path.size());
+
+    const qsizetype written = PathKernels::collapseSeparators(path.data(), path.size(), out.data() + start);
+
+    out.resize(start + written);
+}
+
+QByteArrayView Converter::fileNameOf(QByteArrayView path)
+{
+    const qsizetype lastSep = path.lastIndexOf('\\');
+    if (lastSep < 0 && path.size() >= 2 && path[1] == ':') {
+        return path.sliced(2);
+    }
+    return path.sliced(lastSep + 1);
+}
+
 } // namespace LE
@@ -1,6 +1,12 @@
 #pragma once
 
+#include "Encoding.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
 #include <QString>
+#include <QStringView>
+#include <functional>
 #include <stdexcept>
 
 namespace LE {
@@ -10,14 +16,89 @@ enum class LocationMode {
     Custom
 };
 
+// Whether converted entries are checked against the file system.
+enum class ValidationMode {
+    Off,
+    Report,     // Missing entries are reported through ConversionHooks and kept
+    Drop        // Missing entries are reported and left out of the output
+};
+
 struct ConversionParams {
     QString inputPath;
     QString outputPath;
     QString basePath;       // Required for M3U→M3U8; optional for M3U8→M3U (custom mode)
     LocationMode locationMode = LocationMode::Keep;
+
+    // Split large inputs at line boundaries and convert the chunks on all
+    // cores. Output is identical to the sequential path; small files ignore it.
+    bool intraFileParallel = false;
+
+    // Carry #EXTM3U, #EXTINF and comment lines over to the output, each in
+    // front of the entry it belongs to. When off, only entries are written.
+    bool keepDirectives = true;
+
+    // Drop entries that point to a file an earlier entry already lists
+    // (same path after normalizePath, ignoring case), with their directives.
+    bool dedup = false;
+
+    // How the input bytes are read when they carry no byte order mark.
+    InputEncoding inputEncoding = InputEncoding::Auto;
+
+    // Relative entries are checked against the output file's folder.
+    ValidationMode validation = ValidationMode::Off;
+
+    // Index written by LibraryIndex::update(). With validation on, a missing
+    // entry whose file is found in the library is rewritten to its new path.
+    QString libraryIndex;
+
+    // Folder of a ConversionCache. An input converted before with the same
+    // parameters is restored from it instead of converted again. Not used
+    // with validation on, whose result depends on the file system.
+    QString cacheDir;
+
+    // Write the per-stage PerfCounters of the conversion to
+    // <outputPath>.perf.json. They are also logged to le.perf when that
+    // category has info messages enabled. Not for outputs restored from the
+    // cache, which run no stage.
+    bool perfReport = false;
+};
+
+// Snapshot of a running conversion, measured against the input file size.
+struct ConversionProgress {
+    qint64 bytesDone  = 0;
+    qint64 bytesTotal = 0;
+    qint64 linesDone  = 0;
+    qint64 missingEntries = 0;      // With validation on
+    qint64 relinkedEntries = 0;     // With validation and a library index
+    qint64 duplicateEntries = 0;    // With dedup
+    bool   cached = false;          // Output restored from ConversionParams::cacheDir
+};
+
+// Thrown by Converter::convert when ConversionHooks::isCanceled returns true.
+// The previous output file, if any, is left untouched.
+class ConversionCanceled : public std::runtime_error {
+public:
+    ConversionCanceled() : std::runtime_error("Conversion canceled.") {}
+};
+
+// Optional callbacks into a running conversion. Invoked on the converting thread.
+struct ConversionHooks {
+    // Throttled to roughly kProgressIntervalMs; always called once at the end.
+    std::function<void(const ConversionProgress&)> progress;
+
+    // Polled after every batch of lines; returning true aborts the conversion.
+    std::function<bool()> isCanceled;
+
+    // Called with the output path of every entry whose file does not exist,
+    // in output order. Only with validation on.
+    std::function<void(const QString& path)> missingEntry;
+
+    static constexpr int kProgressIntervalMs = 100;
 };
 
 // Pure business logic. No QWidget dependencies. Throws std::runtime_error on failure.
+// Output is written to a temporary file and atomically renamed into place on
+// success, so a failed or canceled conversion never damages an existing file.
 class Converter {
 public:
     Converter() = default;
@@ -26,14 +107,22 @@ public:
     Converter(const Converter&) = delete;
     Converter& operator=(const Converter&) = delete;
 
-    void convert(const ConversionParams& params);
-
-private:
-    void convertM3uToM3u8(const ConversionParams& params);
-    void convertM3u8ToM3u(const ConversionParams& params);
+    void convert(const ConversionParams& params, const ConversionHooks& hooks = {});
 
+    // ── Per-entry path helpers (thread-safe, no shared state) ────────────────
     static QString normalizePath(const QString& path);
-    static QString stripLeadingMusicPrefix(const QString& line);
+    static QStringView stripLeadingMusicPrefix(QStringView line);
+
+    // Allocation-free variants used by the per-line loops: the result is
+    // written into `out`, whose capacity is reused from line to line.
+    static void normalizePathInto(QStringView path, QString& out);
+    static QStringView fileNameOf(QStringView path);
+
+    // The same helpers on UTF-8 bytes, used by the conversion pipeline. Every
+    // rule only looks at ASCII characters, so no decoding is needed.
+    static QByteArrayView stripLeadingMusicPrefix(QByteArrayView line);
+    static void normalizePathInto(QByteArrayView path, QByteArray& out);
+    static QByteArrayView fileNameOf(QByteArrayView path);
 };
 
 } // namespace LE
\ No newline at end of file
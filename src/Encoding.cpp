@@ -0,0 +1,41 @@
+#include "Encoding.h"
+#include "Logger.h"
+
+#include <QStringDecoder>
+
+namespace LE::Encoding {
+
+Bom detectBom(QByteArrayView data) noexcept
+{
+    if (data.startsWith("\xEF\xBB\xBF")) return Bom::Utf8;
+    if (data.startsWith("\xFF\xFE"))     return Bom::Utf16LE;
+    if (data.startsWith("\xFE\xFF"))     return Bom::Utf16BE;
+    return Bom::None;
+}
+
+QByteArrayView prepare(QByteArrayView data, InputEncoding& encoding, QByteArray& storage)
+{
+    const Bom bom = detectBom(data);
+    switch (bom) {
+        case Bom::None:
+            return data;
+
+        // Declared UTF-8: bad bytes are damage, not another code page.
+        case Bom::Utf8:
+            encoding = InputEncoding::Utf8;
+            return data;
+
+        case Bom::Utf16LE:
+        case Bom::Utf16BE: {
+            const auto utf16 = (bom == Bom::Utf16LE) ? QStringConverter::Utf16LE : QStringConverter::Utf16BE;
+            QStringDecoder decoder(utf16);          // Drops the BOM
+            storage = QString(decoder(data)).toUtf8();
+            encoding = InputEncoding::Utf8;
+            qCDebug(lcConverter) << "UTF-16 input transcoded to UTF-8:" << data.size() << "->" << storage.size() << "bytes";
+            return storage;
+        }
+    }
+    return data;
+}
+
+} // namespace LE::Encoding
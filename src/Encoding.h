@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+namespace LE {
+
+// How the bytes of a playlist are read as text (ConversionParams::inputEncoding).
+// A byte order mark overrides it: such files are read as the BOM says.
+enum class InputEncoding {
+    Auto,           // UTF-8; a line that is not valid UTF-8 is read as Windows-1252
+    Utf8,           // UTF-8 only; invalid bytes become U+FFFD
+    Windows1252     // Legacy players; also covers every printable Latin-1 character
+};
+
+namespace Encoding {
+
+enum class Bom {
+    None,
+    Utf8,
+    Utf16LE,
+    Utf16BE
+};
+
+[[nodiscard]] Bom detectBom(QByteArrayView data) noexcept;
+
+// The pipeline reads UTF-8 (or a legacy 8-bit code page) line by line.
+// Returns `data` itself, or for UTF-16 input its UTF-8 transcoding, stored
+// in `storage`; `encoding` is updated to how the result must be read.
+//
+// Deciding per line rather than per file is what keeps detection free:
+// every line is validated as UTF-8 anyway, ASCII lines (the common case) in
+// a vectorized skip, and a line that fails is decoded right there, so no
+// extra pass over the file is needed.
+[[nodiscard]] QByteArrayView prepare(QByteArrayView data, InputEncoding& encoding, QByteArray& storage);
+
+} // namespace Encoding
+
+} // namespace LE
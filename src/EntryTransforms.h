@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Pipeline.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+namespace LE {
+
+// Steps of the per-entry rewrite, combined into an EntryKernel per
+// direction and location mode. Adding a rewrite means adding a step here and
+// listing it in ConversionJob's kernels for the directions that need it. A
+// base folder in front of every entry is not a step: it is the Pipeline's
+// output prefix, which is kept once per conversion instead of being copied
+// into each entry. Entries are valid UTF-8; see EntryKernel.
+//
+// Steps are defined here so that every kernel inlines them.
+
+// Removes a leading "Music/" (M3U exports relative to the library root).
+struct StripMusicPrefix {
+    static constexpr bool kWritesBuffer = false;
+
+    static bool apply(QByteArrayView& entry, QByteArray&)
+    {
+        entry = Converter::stripLeadingMusicPrefix(entry);
+        return true;
+    }
+};
+
+// Collapses every separator run to a single backslash; see Converter::normalizePath.
+struct NormalizeSeparators {
+    static constexpr bool kWritesBuffer = true;
+
+    static bool apply(QByteArrayView& entry, QByteArray& buffer)
+    {
+        Converter::normalizePathInto(entry, buffer);
+        entry = buffer;
+        return true;
+    }
+};
+
+// Keeps only the file name of the entry (Windows semantics, see Converter::fileNameOf).
+struct KeepFileName {
+    static constexpr bool kWritesBuffer = false;
+
+    static bool apply(QByteArrayView& entry, QByteArray&)
+    {
+        entry = Converter::fileNameOf(entry);
+        return true;
+    }
+};
+
+} // namespace LE
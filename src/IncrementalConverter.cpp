@@ -0,0 +1,180 @@
+#include "IncrementalConverter.h"
+#include "ConversionJob.h"
+#include "LineReader.h"
+#include "OutputWriter.h"
+#include "Pipeline.h"
+#include "Playlist.h"
+#include "Logger.h"
+
+#include <QFileInfo>
+#include <QHashFunctions>
+#include <QSaveFile>
+
+#include <utility>
+
+namespace LE {
+
+namespace {
+
+struct Span {
+    qsizetype begin = 0;
+    qsizetype size  = 0;
+};
+
+// Content-defined cut points, see IncrementalConverter. Uses the same line
+// rules as the pipeline, so a block never ends between a directive and its entry.
+std::vector<Span> cutBlocks(QByteArrayView data, InputEncoding encoding)
+{
+    constexpr std::size_t mask = (std::size_t(1) << IncrementalConverter::kBoundaryBits) - 1;
+
+    std::vector<Span> blocks;
+    LineReader  reader(data, LineReader::Bom::Keep);
+    LineCleaner cleaner(encoding);
+    qsizetype   begin = 0;
+
+    QByteArrayView raw;
+    while (reader.next(raw)) {
+        const QByteArrayView line = cleaner.clean(raw);
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        const qsizetype end = reader.position();
+        if ((qHashBits(line.data(), static_cast<std::size_t>(line.size())) & mask) == 0 ||
+            end - begin >= IncrementalConverter::kMaxBlockBytes)
+        {
+            blocks.push_back({begin, end - begin});
+            begin = end;
+        }
+    }
+    if (begin < data.size()) {
+        blocks.push_back({begin, data.size() - begin});
+    }
+    return blocks;
+}
+
+} // namespace
+
+IncrementalConverter::IncrementalConverter(ConversionParams params)
+    : m_params(std::move(params))
+{}
+
+IncrementalConverter::Result IncrementalConverter::update(const ConversionHooks& hooks)
+{
+    ConversionJob job(m_params);
+    const MappedFile input(m_params.inputPath);
+
+    QByteArrayView data = job.prepareInput(input.data());
+    QByteArray header = job.header(data);
+    if (data.startsWith("\xEF\xBB\xBF")) {
+        data = data.sliced(3);
+    }
+
+    // ── Match the new blocks against the previous ones ───────────────────────
+    const std::vector<Span> spans = cutBlocks(data, job.inputEncoding());
+    std::vector<Block> blocks(spans.size());
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        const QByteArrayView bytes = data.sliced(spans[i].begin, spans[i].size);
+        blocks[i].hash      = qHashBits(bytes.data(), static_cast<std::size_t>(bytes.size()));
+        blocks[i].inputSize = bytes.size();
+    }
+
+    const auto same = [](const Block& a, const Block& b) {
+        return a.hash == b.hash && a.inputSize == b.inputSize;
+    };
+
+    std::size_t prefix = 0;
+    if (m_converted) {
+        while (prefix < blocks.size() && prefix < m_blocks.size() && same(blocks[prefix], m_blocks[prefix])) {
+            blocks[prefix].output = m_blocks[prefix].output;
+            ++prefix;
+        }
+    }
+
+    std::size_t suffix = 0;
+    if (m_converted) {
+        while (suffix < blocks.size() - prefix && suffix < m_blocks.size() - prefix &&
+               same(blocks[blocks.size() - 1 - suffix], m_blocks[m_blocks.size() - 1 - suffix]))
+        {
+            blocks[blocks.size() - 1 - suffix].output = m_blocks[m_blocks.size() - 1 - suffix].output;
+            ++suffix;
+        }
+    }
+
+    Result result;
+    result.blocks          = static_cast<qint64>(blocks.size());
+    result.blocksConverted = static_cast<qint64>(blocks.size() - prefix - suffix);
+
+    if (m_converted && result.blocksConverted == 0 && blocks.size() == m_blocks.size() &&
+        header == m_header && QFileInfo::exists(m_params.outputPath))
+    {
+        qCDebug(lcConverter) << "Unchanged, not rewritten:" << m_params.outputPath;
+        return result;
+    }
+
+    // ── Convert the changed blocks ───────────────────────────────────────────
+    qint64 bytesTotal = 0;
+    for (std::size_t i = prefix; i < blocks.size() - suffix; ++i) {
+        bytesTotal += blocks[i].inputSize;
+    }
+
+    const Pipeline pipeline = job.pipeline();
+    JobMonitor monitor(hooks, bytesTotal);
+    MemorySink sink;
+    qint64 bytesDone = 0;
+    qint64 linesRead = 0;
+
+    for (std::size_t i = prefix; i < blocks.size() - suffix; ++i) {
+        sink.clear();
+        linesRead += pipeline.runChunk(data.sliced(spans[i].begin, spans[i].size), sink, monitor);
+        blocks[i].output = sink.bytes();
+
+        bytesDone += blocks[i].inputSize;
+        monitor.checkpoint(bytesDone, linesRead);
+    }
+
+    // ── Write ────────────────────────────────────────────────────────────────
+    QSaveFile outFile(m_params.outputPath);
+    openOutput(outFile);
+    OutputWriter out(outFile);
+
+    out.appendUtf8(header);
+    if (m_params.dedup) {
+        writeDeduplicated(blocks, out, monitor);
+    } else {
+        for (const Block& block : blocks) {
+            out.appendUtf8(block.output);
+        }
+    }
+    out.finish();
+
+    monitor.finish(linesRead);
+    job.logSummary(monitor);
+    commitOutput(outFile);
+
+    qCInfo(lcConverter) << "Reconverted" << result.blocksConverted << "of" << result.blocks << "blocks:"
+                        << m_params.outputPath;
+
+    m_converted = true;
+    m_header    = std::move(header);
+    m_blocks    = std::move(blocks);
+    result.written = true;
+    return result;
+}
+
+// Blocks hold their output before deduplication: whether an entry repeats
+// depends on every block before it, so the whole output is filtered on each
+// write. Output lines are complete paths, hence the empty prefix.
+void IncrementalConverter::writeDeduplicated(const std::vector<Block>& blocks, OutputWriter& out,
+                                             JobMonitor& monitor)
+{
+    EntryDeduplicator dedup({});
+    for (const auto& block : blocks) {
+        Playlist lines = Playlist::parse(block.output, InputEncoding::Utf8);
+        monitor.reportDuplicates(dedup.filter(lines));
+        for (qsizetype i = 0; i < lines.size(); ++i) {
+            out.appendUtf8(lines.text(i));
+            out.endLine();
+        }
+    }
+}
+
+} // namespace LE
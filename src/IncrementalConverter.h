@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Converter.h"
+
+#include <QByteArray>
+
+#include <vector>
+
+namespace LE {
+
+class JobMonitor;
+class OutputWriter;
+
+// Converts one playlist again every time it changes (watch mode), redoing
+// only the parts of the input that changed.
+//
+// The input is cut into blocks at content-defined points: after each entry
+// line whose hash has its low kBoundaryBits bits clear, so about one block per
+// 2^kBoundaryBits entries. A cut depends only on the line it follows, so an
+// edit moves the boundaries of the blocks it touches and no others; the blocks
+// before and after it are recognized by their hash and keep their previous
+// output. Every block ends after an entry, which makes blocks convert
+// independently (see Pipeline::entryBoundary).
+//
+// The output is byte-identical to Converter::convert() and is still replaced
+// as a whole, atomically: a media server reading the playlist must never see
+// it half patched. When no block changed, the output is not written at all.
+//
+// With validation on, a reused block keeps the result of the check made when
+// it was last converted. With dedup on, blocks are converted without it and
+// the whole output is deduplicated as it is written.
+class IncrementalConverter {
+public:
+    static constexpr int       kBoundaryBits  = 6;
+    static constexpr qsizetype kMaxBlockBytes = qsizetype(1) << 20;   // Cut anyway after this
+
+    struct Result {
+        qint64 blocks          = 0;
+        qint64 blocksConverted = 0;
+        bool   written         = false;     // False if the output was up to date
+    };
+
+    explicit IncrementalConverter(ConversionParams params);
+
+    [[nodiscard]] const ConversionParams& params() const noexcept { return m_params; }
+
+    // Brings the output up to date with the input; the first call converts
+    // everything. Throws like Converter::convert(). A failed update leaves the
+    // output file and the remembered blocks as they were.
+    Result update(const ConversionHooks& hooks = {});
+
+private:
+    struct Block {
+        std::size_t hash      = 0;
+        qsizetype   inputSize = 0;
+        QByteArray  output;         // Shared with the previous update when reused
+    };
+
+    static void writeDeduplicated(const std::vector<Block>& blocks, OutputWriter& out, JobMonitor& monitor);
+
+    ConversionParams   m_params;
+    bool               m_converted = false;
+    QByteArray         m_header;
+    std::vector<Block> m_blocks;
+};
+
+} // namespace LE
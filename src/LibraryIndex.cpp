@@ -0,0 +1,510 @@
+#include "LibraryIndex.h"
+#include "LineReader.h"
+#include "Parallel.h"
+#include "Logger.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace LE {
+
+// ─── On-disk format ──────────────────────────────────────────────────────────
+//
+//   Header
+//   DirectoryRecord[directoryCount]    breadth-first from the root
+//   FileRecord[fileCount]              grouped by directory, sorted by name
+//   quint32[fileCount]                 record indices sorted by (nameHash, size)
+//   char[stringBytes]                  UTF-8 names and relative paths
+//
+// Every table starts at a multiple of 8 bytes, so the mapped file is used in place.
+
+struct LibraryIndex::Header {
+    char    magic[8];
+    quint32 version;
+    quint32 flags;
+    quint32 directoryCount;
+    quint32 fileCount;
+    quint32 rootOffset;
+    quint32 rootLength;
+    quint64 stringBytes;
+};
+
+struct LibraryIndex::DirectoryRecord {
+    quint32 pathOffset;         // Relative to the root, '/' separators; empty for the root
+    quint32 pathLength;
+    qint64  mtime;              // ms since the epoch
+    quint32 firstFile;
+    quint32 fileCount;
+    quint32 firstChild;         // Breadth-first order keeps the children of a
+    quint32 childCount;         // directory next to each other
+};
+
+struct LibraryIndex::FileRecord {
+    quint64 nameHash;           // Of the folded name, see hashName()
+    qint64  size;
+    quint32 directory;
+    quint32 nameOffset;
+    quint32 nameLength;
+    quint32 reserved;
+};
+
+namespace {
+
+constexpr char    kMagic[8]    = {'L', 'E', 'L', 'I', 'B', 'I', 'D', 'X'};
+constexpr quint32 kFoldedNames = 0x1;
+
+// Windows file names are case-insensitive.
+#ifdef Q_OS_WIN
+constexpr quint32 kNativeFlags = kFoldedNames;
+#else
+constexpr quint32 kNativeFlags = 0;
+#endif
+
+QString foldCase(QStringView name, bool fold)
+{
+    return fold ? name.toCaseFolded() : name.toString();
+}
+
+// FNV-1a over the UTF-8 name: unlike qHash it is the same in every process,
+// which a persistent index needs.
+quint64 hashName(QByteArrayView utf8) noexcept
+{
+    quint64 hash = 0xcbf29ce484222325ull;
+    for (const char c : utf8) {
+        hash ^= static_cast<uchar>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+quint64 hashName(QStringView name, bool fold)
+{
+    return hashName(foldCase(name, fold).toUtf8());
+}
+
+QString joinPath(const QString& base, QStringView name)
+{
+    QString path = base;
+    if (!path.isEmpty() && !path.endsWith(u'/')) {
+        path += u'/';
+    }
+    path += name;
+    return path;
+}
+
+struct ScannedFile {
+    QByteArray name;            // UTF-8, as on disk
+    qint64     size = 0;
+    quint64    nameHash = 0;
+};
+
+struct ScannedDirectory {
+    QString     path;           // Relative to the root
+    qint64      mtime = -1;     // Stays -1 if the folder vanished during the scan
+    bool        listed = false;
+    std::vector<ScannedFile> files;
+    QStringList children;       // Relative paths
+    quint32     firstChild = 0;
+    quint32     childCount = 0;
+};
+
+} // namespace
+
+// ─── Update ──────────────────────────────────────────────────────────────────
+
+LibraryIndex::UpdateStats LibraryIndex::update(const QString& root, const QString& indexPath)
+{
+    const QFileInfo rootInfo(root);
+    if (!rootInfo.isDir()) {
+        throw std::runtime_error("Library folder not found: " + root.toStdString());
+    }
+    const QString rootPath = QDir::cleanPath(rootInfo.absoluteFilePath());
+    const bool fold = (kNativeFlags & kFoldedNames) != 0;
+
+    std::vector<ScannedDirectory> directories;
+
+    // The previous index is only read while scanning; it has to be unmapped
+    // before the new file can replace it.
+    {
+        std::unique_ptr<LibraryIndex> previous;
+        if (QFileInfo::exists(indexPath)) {
+            try {
+                previous = std::make_unique<LibraryIndex>(indexPath);
+                if (previous->m_header->flags != kNativeFlags || previous->root() != rootPath) {
+                    qCInfo(lcConverter) << "Library index was built for another folder, rebuilding:" << indexPath;
+                    previous.reset();
+                }
+            } catch (const std::exception& e) {
+                qCWarning(lcConverter) << "Rebuilding library index:" << e.what();
+            }
+        }
+
+        QHash<QString, quint32> previousDirectories;
+        if (previous) {
+            previousDirectories.reserve(previous->directoryCount());
+            for (quint32 i = 0; i < previous->m_header->directoryCount; ++i) {
+                const DirectoryRecord& record = previous->m_directories[i];
+                previousDirectories.insert(QString::fromUtf8(previous->string(record.pathOffset, record.pathLength)), i);
+            }
+        }
+
+        // An unchanged mtime means the same entries as last time: copy them
+        // over instead of listing the folder.
+        const auto reuse = [&](ScannedDirectory& dir) {
+            const auto it = previousDirectories.constFind(dir.path);
+            if (it == previousDirectories.cend()) return false;
+
+            const DirectoryRecord& record = previous->m_directories[*it];
+            if (record.mtime != dir.mtime) return false;
+
+            for (quint32 f = record.firstFile; f < record.firstFile + record.fileCount; ++f) {
+                const FileRecord& file = previous->m_files[f];
+                dir.files.push_back({previous->string(file.nameOffset, file.nameLength).toByteArray(),
+                                     file.size, file.nameHash});
+            }
+            for (quint32 c = record.firstChild; c < record.firstChild + record.childCount; ++c) {
+                const DirectoryRecord& child = previous->m_directories[c];
+                dir.children.append(QString::fromUtf8(previous->string(child.pathOffset, child.pathLength)));
+            }
+            return true;
+        };
+
+        const auto scan = [&](ScannedDirectory& dir) {
+            const QString absolute = joinPath(rootPath, dir.path);
+            const QFileInfo info(absolute);
+            if (!info.isDir()) return;
+
+            dir.mtime = info.lastModified().toMSecsSinceEpoch();
+            if (previous && reuse(dir)) return;
+
+            dir.listed = true;
+            QDirIterator it(absolute, QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+            while (it.hasNext()) {
+                it.next();
+                const QFileInfo entry = it.fileInfo();
+                if (entry.isDir()) {
+                    // Links and junctions may lead back into the tree.
+                    if (!entry.isSymLink() && !entry.isJunction()) {
+                        dir.children.append(joinPath(dir.path, it.fileName()));
+                    }
+                } else {
+                    dir.files.push_back({it.fileName().toUtf8(), entry.size(), hashName(it.fileName(), fold)});
+                }
+            }
+
+            std::sort(dir.files.begin(), dir.files.end(),
+                      [](const ScannedFile& a, const ScannedFile& b) { return a.name < b.name; });
+            dir.children.sort();
+        };
+
+        // One level of the tree at a time, each level in parallel.
+        QThreadPool pool;
+        pool.setMaxThreadCount(kScanThreads);
+
+        directories.emplace_back();
+        std::size_t levelBegin = 0;
+        while (levelBegin < directories.size()) {
+            const std::size_t levelEnd = directories.size();
+            parallelFor(static_cast<int>(levelEnd - levelBegin), [&](int i) {
+                scan(directories[levelBegin + static_cast<std::size_t>(i)]);
+            }, &pool);
+
+            for (std::size_t d = levelBegin; d < levelEnd; ++d) {
+                const QStringList children = std::exchange(directories[d].children, {});
+                directories[d].firstChild = static_cast<quint32>(directories.size());
+                directories[d].childCount = static_cast<quint32>(children.size());
+                for (const QString& child : children) {
+                    directories.emplace_back().path = child;
+                }
+            }
+            levelBegin = levelEnd;
+        }
+    }
+
+    // ── Serialize ────────────────────────────────────────────────────────────
+    QByteArray strings;
+    const auto intern = [&](QByteArrayView text) {
+        if (strings.size() + text.size() > static_cast<qsizetype>(std::numeric_limits<quint32>::max())) {
+            throw std::runtime_error("Library index is too large (more than 4 GiB of names).");
+        }
+        const auto offset = static_cast<quint32>(strings.size());
+        strings.append(text);
+        return offset;
+    };
+
+    UpdateStats stats;
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags   = kNativeFlags;
+
+    const QByteArray rootUtf8 = rootPath.toUtf8();
+    header.rootOffset = intern(rootUtf8);
+    header.rootLength = static_cast<quint32>(rootUtf8.size());
+
+    std::vector<DirectoryRecord> directoryRecords;
+    std::vector<FileRecord> fileRecords;
+    directoryRecords.reserve(directories.size());
+
+    for (std::size_t d = 0; d < directories.size(); ++d) {
+        const ScannedDirectory& dir = directories[d];
+        const QByteArray path = dir.path.toUtf8();
+
+        DirectoryRecord record{};
+        record.pathOffset = intern(path);
+        record.pathLength = static_cast<quint32>(path.size());
+        record.mtime      = dir.mtime;
+        record.firstFile  = static_cast<quint32>(fileRecords.size());
+        record.fileCount  = static_cast<quint32>(dir.files.size());
+        record.firstChild = dir.firstChild;
+        record.childCount = dir.childCount;
+        directoryRecords.push_back(record);
+
+        for (const ScannedFile& file : dir.files) {
+            FileRecord fileRecord{};
+            fileRecord.nameHash   = file.nameHash;
+            fileRecord.size       = file.size;
+            fileRecord.directory  = static_cast<quint32>(d);
+            fileRecord.nameOffset = intern(file.name);
+            fileRecord.nameLength = static_cast<quint32>(file.name.size());
+            fileRecords.push_back(fileRecord);
+        }
+
+        stats.directoriesListed += dir.listed;
+    }
+
+    std::vector<quint32> byName(fileRecords.size());
+    std::iota(byName.begin(), byName.end(), quint32(0));
+    std::sort(byName.begin(), byName.end(), [&](quint32 a, quint32 b) {
+        const FileRecord& ra = fileRecords[a];
+        const FileRecord& rb = fileRecords[b];
+        return std::tie(ra.nameHash, ra.size, a) < std::tie(rb.nameHash, rb.size, b);
+    });
+
+    header.directoryCount = static_cast<quint32>(directoryRecords.size());
+    header.fileCount      = static_cast<quint32>(fileRecords.size());
+    header.stringBytes    = static_cast<quint64>(strings.size());
+
+    QSaveFile out(indexPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Cannot write library index: " + indexPath.toStdString());
+    }
+
+    const auto write = [&](const void* data, std::size_t size) {
+        const auto bytes = static_cast<qint64>(size);
+        if (out.write(static_cast<const char*>(data), bytes) != bytes) {
+            throw std::runtime_error("Cannot write library index: " + out.errorString().toStdString());
+        }
+    };
+
+    write(&header, sizeof(header));
+    write(directoryRecords.data(), directoryRecords.size() * sizeof(DirectoryRecord));
+    write(fileRecords.data(), fileRecords.size() * sizeof(FileRecord));
+    write(byName.data(), byName.size() * sizeof(quint32));
+    write(strings.constData(), static_cast<std::size_t>(strings.size()));
+
+    if (!out.commit()) {
+        throw std::runtime_error("Cannot write library index: " + out.errorString().toStdString());
+    }
+
+    stats.directories = static_cast<qint64>(directoryRecords.size());
+    stats.files       = static_cast<qint64>(fileRecords.size());
+
+    qCInfo(lcConverter) << "Library index updated:" << stats.files << "files in" << stats.directories
+                        << "directories," << stats.directoriesListed << "listed";
+    return stats;
+}
+
+// ─── Lookup ──────────────────────────────────────────────────────────────────
+
+LibraryIndex::LibraryIndex(const QString& indexPath)
+    : m_file(std::make_unique<MappedFile>(indexPath))
+{
+    static_assert(sizeof(Header) == 40 && sizeof(DirectoryRecord) == 32 && sizeof(FileRecord) == 32,
+                  "The index layout must not depend on the compiler");
+
+    const QByteArrayView data = m_file->data();
+    const auto invalid = [&]() {
+        return std::runtime_error("Not a valid library index: " + indexPath.toStdString());
+    };
+
+    if (data.size() < static_cast<qsizetype>(sizeof(Header))) throw invalid();
+    m_header = reinterpret_cast<const Header*>(data.data());
+    if (std::memcmp(m_header->magic, kMagic, sizeof(kMagic)) != 0 || m_header->version != kVersion) {
+        throw invalid();
+    }
+
+    const auto fileSize = static_cast<quint64>(data.size());
+    const quint64 directories = m_header->directoryCount;
+    const quint64 files       = m_header->fileCount;
+    const quint64 tables = sizeof(Header) + directories * sizeof(DirectoryRecord)
+                         + files * (sizeof(FileRecord) + sizeof(quint32));
+    if (tables > fileSize || m_header->stringBytes != fileSize - tables) throw invalid();
+
+    const char* const base = data.data() + sizeof(Header);
+    m_directories = reinterpret_cast<const DirectoryRecord*>(base);
+    m_files       = reinterpret_cast<const FileRecord*>(m_directories + directories);
+    m_byName      = reinterpret_cast<const quint32*>(m_files + files);
+    m_strings     = reinterpret_cast<const char*>(m_byName + files);
+
+    // Bounds-check every offset once, so lookups can trust them.
+    const quint64 stringBytes = m_header->stringBytes;
+    const auto inStrings = [&](quint32 offset, quint32 length) {
+        return quint64(offset) + length <= stringBytes;
+    };
+
+    if (directories == 0 || !inStrings(m_header->rootOffset, m_header->rootLength)) throw invalid();
+    for (quint64 d = 0; d < directories; ++d) {
+        const DirectoryRecord& record = m_directories[d];
+        if (!inStrings(record.pathOffset, record.pathLength) ||
+            quint64(record.firstFile) + record.fileCount > files ||
+            quint64(record.firstChild) + record.childCount > directories)
+        {
+            throw invalid();
+        }
+    }
+    for (quint64 f = 0; f < files; ++f) {
+        const FileRecord& record = m_files[f];
+        if (record.directory >= directories || !inStrings(record.nameOffset, record.nameLength) ||
+            m_byName[f] >= files)
+        {
+            throw invalid();
+        }
+    }
+}
+
+LibraryIndex::~LibraryIndex() = default;
+
+QString LibraryIndex::root() const
+{
+    return QString::fromUtf8(string(m_header->rootOffset, m_header->rootLength));
+}
+
+qsizetype LibraryIndex::directoryCount() const noexcept
+{
+    return m_header->directoryCount;
+}
+
+qsizetype LibraryIndex::fileCount() const noexcept
+{
+    return m_header->fileCount;
+}
+
+QStringList LibraryIndex::find(QStringView fileName, qint64 size) const
+{
+    std::vector<quint32> matches;
+    lookup(fileName, size, matches);
+
+    QStringList paths;
+    paths.reserve(static_cast<qsizetype>(matches.size()));
+    for (const quint32 file : matches) {
+        paths.append(filePath(file));
+    }
+    return paths;
+}
+
+QString LibraryIndex::relink(QStringView oldPath) const
+{
+    const QString native = QDir::fromNativeSeparators(oldPath.toString());
+    const qsizetype sep = native.lastIndexOf(u'/');
+    const QStringView name = QStringView(native).sliced(sep + 1);
+    if (name.isEmpty()) return {};
+
+    std::vector<quint32> matches;
+    lookup(name, -1, matches);
+    if (matches.empty()) return {};
+    if (matches.size() == 1) return filePath(matches.front());
+
+    // Several files share the name: rank them by how many of the old parent
+    // folders they are still in, counting from the innermost.
+    const auto cs = (m_header->flags & kFoldedNames) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    const QList<QStringView> oldFolders = QStringView(native).first(std::max<qsizetype>(sep, 0))
+                                              .split(u'/', Qt::SkipEmptyParts);
+    const QString rootPath = root();
+
+    quint32 best = 0;
+    qsizetype bestScore = -1;
+    bool tie = false;
+
+    for (const quint32 file : matches) {
+        const DirectoryRecord& dir = m_directories[m_files[file].directory];
+        const QString folder = joinPath(rootPath, QString::fromUtf8(string(dir.pathOffset, dir.pathLength)));
+        const QList<QStringView> folders = QStringView(folder).split(u'/', Qt::SkipEmptyParts);
+
+        qsizetype score = 0;
+        while (score < folders.size() && score < oldFolders.size() &&
+               folders[folders.size() - 1 - score].compare(oldFolders[oldFolders.size() - 1 - score], cs) == 0)
+        {
+            ++score;
+        }
+
+        if (score > bestScore) {
+            best = file;
+            bestScore = score;
+            tie = false;
+        } else if (score == bestScore) {
+            tie = true;
+        }
+    }
+
+    return tie ? QString() : filePath(best);
+}
+
+void LibraryIndex::lookup(QStringView fileName, qint64 size, std::vector<quint32>& matches) const
+{
+    matches.clear();
+
+    const bool fold = (m_header->flags & kFoldedNames) != 0;
+    const QString folded = foldCase(fileName, fold);
+    const QByteArray key = folded.toUtf8();
+
+    // The permutation is sorted by (hash, size); without a size, by hash alone.
+    using Key = std::pair<quint64, qint64>;
+    const Key wanted{hashName(key), std::max<qint64>(size, 0)};
+    const auto keyOf = [&](quint32 file) {
+        const FileRecord& record = m_files[file];
+        return Key{record.nameHash, size < 0 ? 0 : record.size};
+    };
+
+    const quint32* const end = m_byName + m_header->fileCount;
+    const quint32* const first = std::lower_bound(m_byName, end, wanted,
+                                                  [&](quint32 file, const Key& k) { return keyOf(file) < k; });
+    const quint32* const last = std::upper_bound(first, end, wanted,
+                                                 [&](const Key& k, quint32 file) { return k < keyOf(file); });
+
+    // Rule out hash collisions.
+    for (const quint32* it = first; it != last; ++it) {
+        const FileRecord& record = m_files[*it];
+        const QByteArrayView name = string(record.nameOffset, record.nameLength);
+        if (fold ? foldCase(QString::fromUtf8(name), true) == folded : name == key) {
+            matches.push_back(*it);
+        }
+    }
+}
+
+QByteArrayView LibraryIndex::string(quint32 offset, quint32 length) const noexcept
+{
+    return QByteArrayView(m_strings + offset, length);
+}
+
+QString LibraryIndex::filePath(quint32 file) const
+{
+    const FileRecord& record = m_files[file];
+    const DirectoryRecord& dir = m_directories[record.directory];
+    const QString folder = joinPath(root(), QString::fromUtf8(string(dir.pathOffset, dir.pathLength)));
+    return joinPath(folder, QString::fromUtf8(string(record.nameOffset, record.nameLength)));
+}
+
+} // namespace LE
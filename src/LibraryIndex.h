@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+#include <memory>
+#include <vector>
+
+namespace LE {
+
+class MappedFile;
+
+// Persistent index of every file under a music library folder, used to find
+// tracks that were moved since a playlist was written.
+//
+// The index is a single binary file that is memory-mapped as is: a directory
+// table, the file records grouped by directory, and a permutation of the
+// records sorted by (file name hash, size). Opening it costs one map and
+// looking a file up one binary search, however large the library.
+//
+// update() refreshes the file incrementally. A directory whose mtime did not
+// change has the same entries as last time, so it costs one stat instead of a
+// listing; only folders that gained, lost or renamed entries are read again.
+// (Sizes of files rewritten in place are refreshed on the next listing of their
+// folder.)
+//
+// File names are matched case-insensitively where the file system is. The
+// format is native-endian and tied to kVersion: it is a cache, and update()
+// rebuilds it from scratch when it cannot be read.
+//
+// A LibraryIndex is read-only and safe to share between threads.
+class LibraryIndex {
+public:
+    static constexpr quint32 kVersion = 1;
+
+    // Directory stats and listings are bound by I/O latency, not CPU.
+    static constexpr int kScanThreads = 16;
+
+    struct UpdateStats {
+        qint64 directories       = 0;
+        qint64 directoriesListed = 0;   // The rest were unchanged since the last update
+        qint64 files             = 0;
+    };
+
+    // Scans `root` and atomically replaces the index at `indexPath`. An
+    // existing index of the same root is reused as described above.
+    // Throws std::runtime_error on failure.
+    static UpdateStats update(const QString& root, const QString& indexPath);
+
+    // Maps an index written by update().
+    // Throws std::runtime_error if it cannot be read or is not a valid index.
+    explicit LibraryIndex(const QString& indexPath);
+    ~LibraryIndex();
+
+    LibraryIndex(const LibraryIndex&) = delete;
+    LibraryIndex& operator=(const LibraryIndex&) = delete;
+
+    // Absolute library folder, '/' separators.
+    [[nodiscard]] QString root() const;
+
+    [[nodiscard]] qsizetype directoryCount() const noexcept;
+    [[nodiscard]] qsizetype fileCount() const noexcept;
+
+    // Absolute paths ('/' separators) of the indexed files called `fileName`,
+    // restricted to those of `size` bytes when size >= 0.
+    [[nodiscard]] QStringList find(QStringView fileName, qint64 size = -1) const;
+
+    // New location of a file that is no longer at `oldPath` (any separators):
+    // the indexed file of the same name whose folders match the most trailing
+    // folders of `oldPath`, so "Artist/Album/01.mp3" prefers another
+    // ".../Artist/Album/01.mp3" over some other "01.mp3". Empty if no file has
+    // that name or the best match is a tie.
+    [[nodiscard]] QString relink(QStringView oldPath) const;
+
+private:
+    struct Header;
+    struct DirectoryRecord;
+    struct FileRecord;
+
+    // Indices into m_files of the files called `fileName`.
+    void lookup(QStringView fileName, qint64 size, std::vector<quint32>& matches) const;
+
+    [[nodiscard]] QByteArrayView string(quint32 offset, quint32 length) const noexcept;
+    [[nodiscard]] QString filePath(quint32 file) const;
+
+    std::unique_ptr<MappedFile> m_file;
+
+    const Header*          m_header = nullptr;
+    const DirectoryRecord* m_directories = nullptr;
+    const FileRecord*      m_files = nullptr;
+    const quint32*         m_byName = nullptr;
+    const char*            m_strings = nullptr;
+};
+
+} // namespace LE
@@ -0,0 +1,37 @@
+#include "LineReader.h"
+#include "Logger.h"
+
+#include <stdexcept>
+
+namespace LE {
+
+MappedFile::MappedFile(const QString& path)
+    : m_file(path)
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qCCritical(lcConverter) << "Failed to open input file:" << path;
+        throw std::runtime_error("Cannot open input file: " + path.toStdString());
+    }
+
+    const qint64 size = m_file.size();
+    if (size > 0) {
+        m_map = m_file.map(0, size);
+    }
+
+    if (m_map) {
+        m_data = QByteArrayView(m_map, static_cast<qsizetype>(size));
+    } else {
+        qCDebug(lcConverter) << "Input not mappable, reading into memory:" << path;
+        m_fallback = m_file.readAll();
+        m_data = m_fallback;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+}
+
+} // namespace LE
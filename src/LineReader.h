@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+namespace LE {
+
+// Read-only, contiguous view of an input file.
+// Memory-maps the file when possible; falls back to a single readAll() for
+// devices that cannot be mapped (and for empty files, which QFile::map rejects).
+// Throws std::runtime_error if the file cannot be opened.
+class MappedFile {
+public:
+    explicit MappedFile(const QString& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] QByteArrayView data() const noexcept { return m_data; }
+    [[nodiscard]] qsizetype size() const noexcept { return m_data.size(); }
+    [[nodiscard]] bool isMapped() const noexcept { return m_map != nullptr; }
+
+private:
+    QFile          m_file;
+    uchar*         m_map = nullptr;
+    QByteArray     m_fallback;
+    QByteArrayView m_data;
+};
+
+// Splits a byte buffer into lines without copying.
+// Lines end at '\n'; the terminator and a preceding '\r' are not part of the
+// yielded view. A leading UTF-8 BOM is skipped unless the buffer is a chunk
+// from the middle of a file (Bom::Keep).
+class LineReader {
+public:
+    enum class Bom { Skip, Keep };
+
+    explicit LineReader(QByteArrayView data, Bom bom = Bom::Skip) noexcept
+        : m_data(data)
+    {
+        if (bom == Bom::Skip && m_data.startsWith("\xEF\xBB\xBF")) {
+            m_pos = 3;
+        }
+    }
+
+    // Stores the next line in `line`. Returns false once the input is exhausted.
+    bool next(QByteArrayView& line) noexcept
+    {
+        const qsizetype size = m_data.size();
+        if (m_pos >= size) {
+            return false;
+        }
+
+        const qsizetype nl = m_data.indexOf('\n', m_pos);
+        const qsizetype end = (nl < 0) ? size : nl;
+
+        qsizetype lineEnd = end;
+        if (lineEnd > m_pos && m_data[lineEnd - 1] == '\r') {
+            --lineEnd;
+        }
+
+        line = m_data.sliced(m_pos, lineEnd - m_pos);
+        m_pos = (nl < 0) ? size : nl + 1;
+        return true;
+    }
+
+    // Number of bytes consumed so far, including terminators.
+    [[nodiscard]] qsizetype position() const noexcept { return m_pos; }
+
+private:
+    QByteArrayView m_data;
+    qsizetype      m_pos = 0;
+};
+
+} // namespace LE
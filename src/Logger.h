@@ -6,4 +6,7 @@
 Q_DECLARE_LOGGING_CATEGORY(lcConverter)
 Q_DECLARE_LOGGING_CATEGORY(lcTheme)
 Q_DECLARE_LOGGING_CATEGORY(lcWindow)
-Q_DECLARE_LOGGING_CATEGORY(lcThread)
\ No newline at end of file
+Q_DECLARE_LOGGING_CATEGORY(lcThread)
+Q_DECLARE_LOGGING_CATEGORY(lcCli)
+Q_DECLARE_LOGGING_CATEGORY(lcQueue)
+Q_DECLARE_LOGGING_CATEGORY(lcPerf)
\ No newline at end of file
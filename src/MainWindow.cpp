@@ -1,26 +1,83 @@
 #include "MainWindow.h"
 #include "Logger.h"
+#include "Tracer.h"
 
 #include <QApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QDragEnterEvent>
+#include <QDropEvent>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QMetaObject>
+#include <QMimeData>
+#include <QSet>
 #include <QTimer>
 #include <QFileInfo>
 #include <QIcon>
 #include <QStatusBar>
-#include <QtConcurrent/QtConcurrent>
+#include <QThread>
+#include <QUrl>
+
+#include <algorithm>
+#include <memory>
 
 Q_LOGGING_CATEGORY(lcWindow, "le.window")
 Q_LOGGING_CATEGORY(lcThread, "le.thread")
 
 namespace LE {
 
+namespace {
+
+bool isPlaylist(const QString& path)
+{
+    return path.endsWith(".m3u", Qt::CaseInsensitive) ||
+           path.endsWith(".m3u8", Qt::CaseInsensitive);
+}
+
+// Playlists found below dropped folders are handed to the UI thread in
+// groups this size, so the first jobs start while the walk goes on.
+constexpr int kWalkGroup = 64;
+
+// Combined rate of every job of the batch, so concurrent jobs add up.
+QString formatThroughput(const ConversionQueue::BatchStats& stats)
+{
+    const double seconds = std::max<qint64>(stats.elapsedMs, 1) / 1000.0;
+    const auto linesPerSec = static_cast<qint64>(stats.linesDone / seconds);
+    const double mbPerSec = stats.bytesDone / seconds / 1e6;
+
+    return QString("%L1 lines/s \u00B7 %2 MB/s")
+        .arg(linesPerSec)
+        .arg(mbPerSec, 0, 'f', 1);
+}
+
+// Next to the input, with the extension of the other format.
+QString outputPathFor(const QString& inputPath)
+{
+    const QFileInfo info(inputPath);
+    const QString targetExt = inputPath.endsWith(".m3u", Qt::CaseInsensitive) ? ".m3u8" : ".m3u";
+    return info.dir().filePath(info.completeBaseName() + targetExt);
+}
+
+} // namespace
+
+// What one drop queued and what it refused. Only used on the UI thread.
+struct MainWindow::DropSession {
+    int           generation = 0;
+    QSet<QString> inputs;       // ConversionQueue::pathKey of the queued playlists
+    QSet<QString> outputs;      // ConversionQueue::pathKey of their outputs
+    QStringList   skipped;
+    int           queued = 0;
+};
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
 {
     setWindowFlags(Qt::Window);
-    resize(760, 560);
+    resize(760, 720);
     setMinimumSize(600, 450);
+    setAcceptDrops(true);
+    m_walkPool.setMaxThreadCount(1);
 
     buildUi();
     connectSignals();
@@ -31,6 +88,12 @@ MainWindow::MainWindow(QWidget* parent)
     qCInfo(lcWindow) << "MainWindow constructed";
 }
 
+MainWindow::~MainWindow()
+{
+    ++m_walkGeneration;
+    m_walkPool.waitForDone();
+}
+
 void MainWindow::updateWindowIcon()
 {
     // Forced dark themes always use the white icon.
@@ -71,7 +134,7 @@ void MainWindow::buildCentralContent()
     rootLayout->setContentsMargins(0, 0, 0, 0);
     rootLayout->setSpacing(0);
 
-    // ── Top bar: theme selector pinned to the right ──────────────────────────
+    // ── Top bar: worker count and theme selector pinned to the right ────────
     auto* topBar = new QWidget(central);
     auto* topBarLayout = new QHBoxLayout(topBar);
     topBarLayout->setContentsMargins(8, 8, 12, 4);
@@ -83,7 +146,20 @@ void MainWindow::buildCentralContent()
     // Fixed size prevents any geometry shift when stylesheets change across themes.
     m_themeBox->setFixedSize(110, 28);
 
+    // Conversions of the queue that run at the same time.
+    m_queue = new ConversionQueue(this);
+    m_queue->setMaxThreads(QThread::idealThreadCount());
+
+    m_workersBox = new QSpinBox(topBar);
+    m_workersBox->setObjectName("workersBox");
+    m_workersBox->setPrefix("Workers: ");
+    m_workersBox->setRange(1, std::max(QThread::idealThreadCount() * 2, 2));
+    m_workersBox->setValue(m_queue->maxThreads());
+    m_workersBox->setFixedSize(110, 28);
+
     topBarLayout->addStretch();
+    topBarLayout->addWidget(m_workersBox);
+    topBarLayout->addSpacing(8);
     topBarLayout->addWidget(m_themeBox);
 
     // ── Content area: centred vertically and horizontally ───────────────────
@@ -148,9 +224,16 @@ void MainWindow::buildCentralContent()
     m_convertBtn->setFixedWidth(160);
     m_convertBtn->setEnabled(false);
 
+    // Cancel button (visible while a conversion runs)
+    m_cancelBtn = new QPushButton("Cancel", contentWidget);
+    m_cancelBtn->setObjectName("cancelBtn");
+    m_cancelBtn->setFixedHeight(30);
+    m_cancelBtn->setFixedWidth(100);
+    m_cancelBtn->setVisible(false);
+
     // Progress bar
     m_progressBar = new QProgressBar(contentWidget);
-    m_progressBar->setRange(0, 100);
+    m_progressBar->setRange(0, ConversionQueue::kProgressSteps);
     m_progressBar->setValue(0);
     m_progressBar->setFixedWidth(320);
     m_progressBar->setFixedHeight(6);
@@ -166,10 +249,46 @@ void MainWindow::buildCentralContent()
     contentLayout->addWidget(m_convertBtn,        0, Qt::AlignCenter);
     contentLayout->addSpacing(8);
     contentLayout->addWidget(m_progressBar,       0, Qt::AlignCenter);
+    contentLayout->addWidget(m_cancelBtn,         0, Qt::AlignCenter);
+
+    // ── Queue: one row per conversion, dropped or started with Convert ──────
+    m_queueView = new QListView(central);
+    m_queueView->setObjectName("queueView");
+    m_queueView->setUniformItemSizes(true);
+    m_queueView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_queueView->setTextElideMode(Qt::ElideMiddle);
+    m_queueView->setModel(m_queue);
+    m_queueView->setMaximumHeight(160);
+    m_queueView->setVisible(false);
+
+    // ── Preview: original entries next to their converted form ──────────────
+    // Uniform item sizes let the view lay out millions of rows without asking
+    // the model for each one; only visible rows are ever converted.
+    m_previewWidget = new QWidget(central);
+    m_previewModel  = new PreviewModel(this);
+    m_previewView   = new QListView(m_previewWidget);
+    m_previewView->setObjectName("previewView");
+    m_previewView->setUniformItemSizes(true);
+    m_previewView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_previewView->setModel(m_previewModel);
+    m_previewView->setItemDelegate(new PreviewDelegate(m_previewView));
+    {
+        auto* area = new QVBoxLayout(m_previewWidget);
+        area->setContentsMargins(12, 0, 12, 12);
+        area->addWidget(m_previewView);
+    }
+    m_previewWidget->setVisible(false);
 
     // ── Assemble root ────────────────────────────────────────────────────────
-    rootLayout->addWidget(topBar,        0);
-    rootLayout->addWidget(contentWidget, 1);
+    rootLayout->addWidget(topBar,          0);
+    rootLayout->addWidget(contentWidget,   1);
+    rootLayout->addWidget(m_previewWidget, 1);
+    {
+        auto* queueArea = new QVBoxLayout;
+        queueArea->setContentsMargins(12, 0, 12, 12);
+        queueArea->addWidget(m_queueView);
+        rootLayout->addLayout(queueArea);
+    }
 
     // ── Status bar ───────────────────────────────────────────────────────────
     m_statusLabel = new QLabel(this);
@@ -188,6 +307,7 @@ void MainWindow::connectSignals()
     connect(m_browseBaseBtn,   &QPushButton::clicked, this, &MainWindow::onBrowseBasePath);
     connect(m_browseCustomBtn, &QPushButton::clicked, this, &MainWindow::onBrowseCustomPath);
     connect(m_convertBtn,      &QPushButton::clicked, this, &MainWindow::onConvert);
+    connect(m_cancelBtn,       &QPushButton::clicked, this, &MainWindow::onCancel);
 
     connect(m_basePathEdit,   &QLineEdit::textChanged,
             this, &MainWindow::onBasePathTextChanged);
@@ -200,8 +320,11 @@ void MainWindow::connectSignals()
     connect(m_themeBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onThemeChanged);
 
-    connect(&m_futureWatcher, &QFutureWatcher<void>::finished,
-            this, &MainWindow::onConversionFinished);
+    connect(m_workersBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            m_queue, &ConversionQueue::setMaxThreads);
+
+    connect(m_queue, &ConversionQueue::progressChanged, this, &MainWindow::onQueueProgress);
+    connect(m_queue, &ConversionQueue::drained,         this, &MainWindow::onQueueDrained);
 }
 
 void MainWindow::onSelectFile()
@@ -230,6 +353,15 @@ void MainWindow::onSelectFile()
         m_customPathWidget->setVisible(m_locationModeBox->currentIndex() == 1);
     }
 
+    try {
+        m_previewModel->setInput(conversionParams(m_filePath));
+        m_previewWidget->setVisible(true);
+    } catch (const std::exception& e) {
+        qCWarning(lcWindow) << "Preview unavailable:" << e.what();
+        m_previewModel->setInput({});
+        m_previewWidget->setVisible(false);
+    }
+
     updateConvertButtonState();
 }
 
@@ -262,57 +394,231 @@ void MainWindow::onConvert()
 
     if (savePath.isEmpty()) return;
 
-    ConversionParams params;
-    params.inputPath  = m_filePath;
+    const TraceSpan span("onConvert", m_filePath);
+    ConversionParams params = conversionParams(m_filePath);
     params.outputPath = savePath;
+    params.intraFileParallel = true;
 
-    if (m_inputExt == "m3u") {
-        params.basePath = m_basePathEdit->text().trimmed();
-    } else {
-        if (m_locationModeBox->currentIndex() == 1) {
-            params.locationMode = LocationMode::Custom;
-            params.basePath = m_customPathEdit->text().trimmed();
-            if (params.basePath.isEmpty()) {
-                showError("Custom base path is required.");
-                return;
-            }
-        } else {
-            params.locationMode = LocationMode::Keep;
-        }
+    if (params.locationMode == LocationMode::Custom && params.basePath.isEmpty()) {
+        showError("Custom base path is required.");
+        return;
     }
 
-    m_conversionError.reset();
+    qCInfo(lcThread) << "Queueing conversion of" << params.inputPath;
+
+    if (!m_queue->enqueue(params)) {
+        showError("A queued conversion is already writing " + QDir::toNativeSeparators(savePath) + ".");
+        return;
+    }
     setConversionInProgress(true);
+}
+
+void MainWindow::onCancel()
+{
+    qCInfo(lcThread) << "Cancellation requested";
+
+    m_cancelBtn->setEnabled(false);
+    m_statusLabel->setText("Canceling\u2026");
+    ++m_walkGeneration;
+    m_queue->cancelAll();
+}
+
+void MainWindow::dragEnterEvent(QDragEnterEvent* event)
+{
+    if (event->mimeData()->hasUrls()) {
+        event->acceptProposedAction();
+    }
+}
+
+void MainWindow::dropEvent(QDropEvent* event)
+{
+    const TraceSpan span("dropEvent");
+
+    QStringList files;
+    QStringList folders;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        if (!url.isLocalFile()) continue;
+
+        const QString path = url.toLocalFile();
+        if (QFileInfo(path).isDir()) {
+            folders << path;
+        } else if (isPlaylist(path)) {
+            files << path;
+        }
+    }
+    if (files.isEmpty() && folders.isEmpty()) {
+        m_statusLabel->setText("No playlists dropped.");
+        statusBar()->setVisible(true);
+        return;
+    }
+    event->acceptProposedAction();
+
+    auto session = std::make_shared<DropSession>();
+    session->generation = m_walkGeneration;
+    queueDropped(*session, files);
+    if (folders.isEmpty()) {
+        finishDrop(*session);
+        return;
+    }
 
-    qCInfo(lcThread) << "Dispatching conversion to thread pool";
+    ++m_walksRunning;
+    if (!m_queue->isBusy()) {
+        setConversionInProgress(true);
+        m_progressBar->setValue(0);
+        m_statusLabel->setText("Looking for playlists\u2026");
+    }
 
-    auto future = QtConcurrent::run([this, params]() {
-        try {
-            m_converter.convert(params);
-        } catch (const std::exception& e) {
-            m_conversionError = e.what();
+    // The session is only touched by the lambdas posted back to this thread.
+    m_walkPool.start([this, folders, session, generation = session->generation] {
+        const TraceSpan walkSpan("walk dropped folders");
+        const auto post = [this](auto update) {
+            QMetaObject::invokeMethod(this, std::move(update), Qt::QueuedConnection);
+        };
+
+        QStringList found;
+        for (const QString& folder : folders) {
+            QDirIterator it(folder, {"*.m3u", "*.m3u8"}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext() && m_walkGeneration == generation) {
+                found << it.next();
+                if (found.size() == kWalkGroup) {
+                    post([this, session, found] { queueDropped(*session, found); });
+                    found.clear();
+                }
+            }
         }
+        post([this, session, found] {
+            queueDropped(*session, found);
+            --m_walksRunning;
+            finishDrop(*session);
+        });
     });
+}
+
+// The whole queue keeps the cores busy, so every file converts on one.
+// An output that exists is never replaced: it is either a file the user
+// keeps, or another dropped playlist (a.m3u next to a.m3u8). A file found at
+// the output of a job queued by this drop is that job's output. The queue
+// refuses an output that a job queued before the drop is writing.
+void MainWindow::queueDropped(DropSession& session, const QStringList& playlists)
+{
+    if (session.generation != m_walkGeneration) {
+        return;
+    }
+
+    const int queuedBefore = session.queued;
+    for (const QString& input : playlists) {
+        const QString inputKey = ConversionQueue::pathKey(input);
+        if (session.outputs.contains(inputKey)) {
+            continue;
+        }
+
+        const QString output = outputPathFor(input);
+        const QString outputKey = ConversionQueue::pathKey(output);
+        if (session.inputs.contains(outputKey) || session.outputs.contains(outputKey) ||
+            QFileInfo::exists(output))
+        {
+            session.skipped << input;
+            continue;
+        }
+
+        ConversionParams params = conversionParams(input);
+        params.outputPath = output;
+        if (!m_queue->enqueue(params)) {
+            session.skipped << input;
+            continue;
+        }
 
-    m_futureWatcher.setFuture(future);
+        session.inputs.insert(inputKey);
+        session.outputs.insert(outputKey);
+        ++session.queued;
+    }
+
+    if (session.queued > queuedBefore) {
+        setConversionInProgress(true);
+    }
 }
 
-void MainWindow::onConversionFinished()
+void MainWindow::finishDrop(const DropSession& session)
 {
-    qCInfo(lcThread) << "Conversion thread finished";
+    qCInfo(lcThread) << "Queued" << session.queued << "dropped playlists, skipped" << session.skipped.size();
 
-    if (m_conversionError.has_value()) {
-        setConversionInProgress(false);
-        showError(QString::fromStdString(*m_conversionError));
-        m_conversionError.reset();
+    const bool canceled = session.generation != m_walkGeneration;
+    if (!m_queue->isBusy() && m_walksRunning == 0) {
+        if (session.queued > 0) {
+            resetWhenIdle();        // The jobs finished before the walk did
+        } else {
+            setConversionInProgress(false);
+            m_statusLabel->setText(canceled                 ? QString("Canceled.")
+                                 : session.skipped.isEmpty() ? QString("No playlists dropped.")
+                                                             : QString("Nothing converted."));
+            statusBar()->setVisible(true);
+        }
+    }
+    if (canceled) {
         return;
     }
 
-    animateProgressTo(100);
-    m_statusLabel->setText("Completed successfully.");
+    if (!session.skipped.isEmpty()) {
+        constexpr qsizetype kListed = 20;
+        QStringList names;
+        for (qsizetype i = 0; i < std::min(session.skipped.size(), kListed); ++i) {
+            names << QDir::toNativeSeparators(session.skipped[i]);
+        }
+        if (session.skipped.size() > kListed) {
+            names << QString("\u2026 and %1 more").arg(session.skipped.size() - kListed);
+        }
+        QMessageBox::information(this, "Playlists skipped",
+            QString("%1 dropped playlists were not converted because their output already exists or is being written:\n\n%2")
+                .arg(session.skipped.size()).arg(names.join('\n')));
+    }
+}
+
+void MainWindow::onQueueProgress()
+{
+    const ConversionQueue::BatchStats stats = m_queue->batchStats();
+    if (stats.total == 0) return;
 
+    m_progressBar->setValue(m_queue->batchProgress());
+    if (m_queue->isBusy() && m_cancelBtn->isEnabled()) {
+        m_statusLabel->setText(QString("Converting\u2026 %1 of %2 done \u00B7 %3")
+                                   .arg(stats.finished).arg(stats.total).arg(formatThroughput(stats)));
+    }
+}
+
+void MainWindow::onQueueDrained()
+{
+    const TraceSpan span("onQueueDrained");
+    qCInfo(lcThread) << "Conversion queue drained";
+
+    const ConversionQueue::BatchStats stats = m_queue->batchStats();
+    m_progressBar->setValue(m_progressBar->maximum());
+    m_cancelBtn->setVisible(false);
+
+    QString summary;
+    if (stats.failed > 0) {
+        summary = QString("%1 of %2 failed.").arg(stats.failed).arg(stats.total);
+    } else if (stats.canceled > 0) {
+        summary = "Canceled. Existing output left unchanged.";
+    } else {
+        summary = (stats.total == 1) ? QString("Completed successfully.")
+                                     : QString("%1 conversions completed successfully.").arg(stats.total);
+    }
+    m_statusLabel->setText(summary);
+
+    if (stats.failed > 0) {
+        showError(m_queue->batchErrors().join('\n'));
+    }
+
+    resetWhenIdle();
+}
+
+// Leaves the outcome on screen for a moment, unless more work arrives.
+void MainWindow::resetWhenIdle()
+{
     QTimer::singleShot(1200, this, [this]() {
-        setConversionInProgress(false);
+        if (!m_queue->isBusy() && m_walksRunning == 0) {
+            setConversionInProgress(false);
+        }
     });
 }
 
@@ -320,16 +626,19 @@ void MainWindow::onLocationModeChanged(int index)
 {
     m_customPathWidget->setVisible(index == 1);
     updateConvertButtonState();
+    updatePreview();
 }
 
 void MainWindow::onBasePathTextChanged()
 {
     updateConvertButtonState();
+    updatePreview();
 }
 
 void MainWindow::onCustomPathTextChanged()
 {
     updateConvertButtonState();
+    updatePreview();
 }
 
 void MainWindow::onThemeChanged(int index)
@@ -339,6 +648,28 @@ void MainWindow::onThemeChanged(int index)
     updateWindowIcon();
 }
 
+ConversionParams MainWindow::conversionParams(const QString& inputPath) const
+{
+    ConversionParams params;
+    params.inputPath = inputPath;
+
+    if (inputPath.endsWith(".m3u", Qt::CaseInsensitive)) {
+        params.basePath = m_basePathEdit->text().trimmed();
+    } else if (m_locationModeBox->currentIndex() == 1) {
+        params.locationMode = LocationMode::Custom;
+        params.basePath = m_customPathEdit->text().trimmed();
+    }
+    return params;
+}
+
+// Only the rows on screen are converted again.
+void MainWindow::updatePreview()
+{
+    if (!m_filePath.isEmpty()) {
+        m_previewModel->setParams(conversionParams(m_filePath));
+    }
+}
+
 void MainWindow::updateConvertButtonState()
 {
     if (m_filePath.isEmpty()) {
@@ -358,15 +689,18 @@ void MainWindow::updateConvertButtonState()
     }
 }
 
+// Convert stays enabled while the queue runs: another job just joins it.
 void MainWindow::setConversionInProgress(bool inProgress)
 {
-    m_convertBtn->setEnabled(!inProgress);
     m_progressBar->setVisible(inProgress);
+    m_cancelBtn->setVisible(inProgress);
+    m_cancelBtn->setEnabled(inProgress);
 
     if (inProgress) {
-        m_progressBar->setValue(0);
-        m_statusLabel->setText("Processing\u2026");
+        m_queueView->setVisible(true);
+        m_queueView->scrollToBottom();
         statusBar()->setVisible(true);
+        onQueueProgress();
     } else {
         m_progressBar->setValue(0);
         statusBar()->setVisible(false);
@@ -380,20 +714,4 @@ void MainWindow::showError(const QString& message)
     QMessageBox::critical(this, "Error", message);
 }
 
-void MainWindow::animateProgressTo(int targetPercent)
-{
-    auto* timer = new QTimer(this);
-    timer->setInterval(20);
-    connect(timer, &QTimer::timeout, this, [this, timer, targetPercent]() {
-        const int current = m_progressBar->value();
-        if (current >= targetPercent) {
-            timer->stop();
-            timer->deleteLater();
-            return;
-        }
-        m_progressBar->setValue(current + 2);
-    });
-    timer->start();
-}
-
 } // namespace LE
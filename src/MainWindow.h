@@ -2,19 +2,23 @@
 
 #include "ThemeManager.h"
 #include "Converter.h"
+#include "ConversionQueue.h"
+#include "PreviewModel.h"
 
 #include <QMainWindow>
 #include <QStatusBar>
-#include <QFutureWatcher>
 #include <QLabel>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QComboBox>
 #include <QProgressBar>
+#include <QSpinBox>
+#include <QListView>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-#include <optional>
-#include <string>
+#include <QThreadPool>
+
+#include <atomic>
 
 namespace LE {
 
@@ -23,28 +27,53 @@ class MainWindow : public QMainWindow {
 
 public:
     explicit MainWindow(QWidget* parent = nullptr);
-    ~MainWindow() override = default;
+
+    // Stops listing dropped folders and waits for the listing thread.
+    ~MainWindow() override;
+
+protected:
+    // Playlists and folders dropped on the window are queued for conversion
+    // next to their input, with the settings currently entered. Folders are
+    // listed on m_walkPool, and each playlist is queued as soon as it is found.
+    // A playlist is skipped if its output already exists: that is either a
+    // file the user did not ask to replace, or another dropped playlist. It
+    // is also skipped if a queued conversion is writing that output.
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
 
 private slots:
     void onSelectFile();
     void onBrowseBasePath();
     void onBrowseCustomPath();
     void onConvert();
-    void onConversionFinished();
+    void onCancel();
+    void onQueueProgress();
+    void onQueueDrained();
     void onLocationModeChanged(int index);
     void onBasePathTextChanged();
     void onCustomPathTextChanged();
     void onThemeChanged(int index);
 
 private:
+    struct DropSession;
+
     void buildUi();
     void buildCentralContent();
     void connectSignals();
 
+    // Base path and location mode as currently entered, for `inputPath`.
+    // The direction follows its extension.
+    ConversionParams conversionParams(const QString& inputPath) const;
+
     void updateConvertButtonState();
+    void updatePreview();
     void setConversionInProgress(bool inProgress);
+    void resetWhenIdle();
     void showError(const QString& message);
-    void animateProgressTo(int targetPercent);
+
+    // Dropped playlists, on the UI thread: queues the ones whose output is free.
+    void queueDropped(DropSession& session, const QStringList& playlists);
+    void finishDrop(const DropSession& session);
 
     // Selects LEwX.ico or LEbX.ico based on the active theme.
     // LEwX: Dark (forced), AMOLED (forced), System when dark.
@@ -62,9 +91,20 @@ private:
     QLineEdit*    m_customPathEdit   = nullptr;
     QPushButton*  m_browseCustomBtn  = nullptr;
     QPushButton*  m_convertBtn       = nullptr;
+    QPushButton*  m_cancelBtn        = nullptr;
     QProgressBar* m_progressBar      = nullptr;
+    QSpinBox*     m_workersBox       = nullptr;
     QComboBox*    m_themeBox         = nullptr;
 
+    // Before/after preview of the selected file (hidden until one is selected)
+    QWidget*      m_previewWidget    = nullptr;
+    QListView*    m_previewView      = nullptr;
+    PreviewModel* m_previewModel     = nullptr;
+
+    // Jobs of the conversion queue (hidden until the first one is queued)
+    QListView*       m_queueView     = nullptr;
+    ConversionQueue* m_queue         = nullptr;
+
     // Owned by the QStatusBar — pointer kept for text updates.
     QLabel*       m_statusLabel      = nullptr;
 
@@ -72,12 +112,13 @@ private:
     QString      m_filePath;
     QString      m_inputExt;
 
-    // Conversion error transported from worker thread to UI thread.
-    std::optional<std::string> m_conversionError;
+    // Listing of dropped folders, one drop at a time. Cancel and the
+    // destructor bump the generation, which stops the walks started before.
+    QThreadPool      m_walkPool;
+    std::atomic<int> m_walkGeneration{0};
+    int              m_walksRunning = 0;
 
-    ThemeManager          m_themeManager;
-    Converter             m_converter;
-    QFutureWatcher<void>  m_futureWatcher;
+    ThemeManager m_themeManager;
 };
 
 } // namespace LE
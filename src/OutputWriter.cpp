@@ -0,0 +1,214 @@
+#include "OutputWriter.h"
+#include "Logger.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace LE {
+
+namespace {
+
+std::optional<std::string> writeAll(QIODevice& device, const char* data, qsizetype size)
+{
+    if (device.write(data, size) != size) {
+        return "Cannot write output file: " + device.errorString().toStdString();
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+OutputWriter::OutputWriter(QIODevice& device, qsizetype bufferSize)
+    : m_device(device)
+    , m_capacity(std::max<qsizetype>(bufferSize, 64))
+{
+    // Only the first buffer is allocated up front; the rest of the ring is
+    // created when the background writer starts.
+    m_storage.reserve(kBufferCount);
+    m_storage.push_back({std::make_unique_for_overwrite<char[]>(m_capacity), 0});
+    m_current = &m_storage.front();
+}
+
+OutputWriter::~OutputWriter()
+{
+    stopThread(false);
+}
+
+void OutputWriter::append(QStringView text)
+{
+    while (!text.isEmpty()) {
+        // UTF-8 needs at most 3 bytes per UTF-16 code unit, plus one byte when
+        // the encoder completes a surrogate pair held over from the last call.
+        const qsizetype room = (m_capacity - m_current->size - 1) / 3;
+        if (room <= 0) {
+            submitCurrent();
+            continue;
+        }
+
+        const QStringView chunk = text.first(std::min(room, text.size()));
+        char* const begin = m_current->data.get();
+        char* const end = m_encoder.appendToBuffer(begin + m_current->size, chunk);
+        m_current->size = end - begin;
+        text = text.sliced(chunk.size());
+    }
+}
+
+void OutputWriter::appendUtf8(QByteArrayView bytes)
+{
+    while (!bytes.isEmpty()) {
+        const qsizetype room = m_capacity - m_current->size;
+        if (room == 0) {
+            submitCurrent();
+            continue;
+        }
+
+        const qsizetype n = std::min(room, bytes.size());
+        std::memcpy(m_current->data.get() + m_current->size, bytes.data(), static_cast<std::size_t>(n));
+        m_current->size += n;
+        bytes = bytes.sliced(n);
+    }
+}
+
+void OutputWriter::finish()
+{
+    if (!m_thread.joinable()) {
+        // Everything fit into one buffer: write it on the calling thread.
+        if (m_current->size > 0) {
+            m_bytesSubmitted += m_current->size;
+            if (auto error = writeTimed(m_current->data.get(), m_current->size)) {
+                qCCritical(lcConverter) << "Output write failed:" << m_device.errorString();
+                throw std::runtime_error(*error);
+            }
+            m_current->size = 0;
+        }
+        return;
+    }
+
+    {
+        const std::lock_guard lock(m_mutex);
+        if (m_current->size > 0) {
+            m_bytesSubmitted += m_current->size;
+            m_full.push_back(m_current);
+            m_current = nullptr;
+        }
+    }
+
+    stopThread(true);
+
+    // All buffers are back in the free list once the writer has drained.
+    if (!m_current) {
+        m_current = m_free.front();
+        m_free.pop_front();
+    }
+
+    throwIfFailed();
+}
+
+void OutputWriter::submitCurrent()
+{
+    if (m_current->size == 0) return;
+
+    if (!m_thread.joinable()) {
+        for (int i = 1; i < kBufferCount; ++i) {
+            m_storage.push_back({std::make_unique_for_overwrite<char[]>(m_capacity), 0});
+        }
+        // Capacity was reserved for kBufferCount, so m_current stays valid.
+        for (int i = 1; i < kBufferCount; ++i) {
+            m_free.push_back(&m_storage[i]);
+        }
+        m_stopping = false;
+        m_drain = true;
+        m_thread = std::thread(&OutputWriter::writerLoop, this);
+        qCDebug(lcConverter) << "Write-behind thread started";
+    }
+
+    m_bytesSubmitted += m_current->size;
+
+    std::unique_lock lock(m_mutex);
+    m_full.push_back(m_current);
+    m_current = nullptr;
+    m_cv.notify_all();
+
+    // Back-pressure: wait until the writer returns a buffer.
+    m_cv.wait(lock, [this] { return !m_free.empty(); });
+    m_current = m_free.front();
+    m_free.pop_front();
+
+    if (m_error) {
+        throw std::runtime_error(*m_error);
+    }
+}
+
+void OutputWriter::writerLoop()
+{
+    std::unique_lock lock(m_mutex);
+
+    for (;;) {
+        m_cv.wait(lock, [this] { return !m_full.empty() || m_stopping; });
+        if (m_full.empty() || (m_stopping && !m_drain)) {
+            break;
+        }
+
+        Buffer* buffer = m_full.front();
+        m_full.pop_front();
+        const bool failed = m_error.has_value();
+        lock.unlock();
+
+        // After a failure remaining buffers are recycled without writing.
+        std::optional<std::string> error;
+        if (!failed) {
+            error = writeTimed(buffer->data.get(), buffer->size);
+        }
+
+        lock.lock();
+        if (error) {
+            qCCritical(lcConverter) << "Output write failed:" << m_device.errorString();
+            m_error = std::move(error);
+        }
+        buffer->size = 0;
+        m_free.push_back(buffer);
+        m_cv.notify_all();
+    }
+
+    // Abandoned buffers go back to the free list so the ring stays complete.
+    while (!m_full.empty()) {
+        m_full.front()->size = 0;
+        m_free.push_back(m_full.front());
+        m_full.pop_front();
+    }
+}
+
+std::optional<std::string> OutputWriter::writeTimed(const char* data, qsizetype size)
+{
+    QElapsedTimer timer;
+    timer.start();
+    auto error = writeAll(m_device, data, size);
+    m_deviceNs += timer.nsecsElapsed();
+    return error;
+}
+
+void OutputWriter::throwIfFailed()
+{
+    const std::lock_guard lock(m_mutex);
+    if (m_error) {
+        throw std::runtime_error(*m_error);
+    }
+}
+
+void OutputWriter::stopThread(bool drain)
+{
+    if (!m_thread.joinable()) return;
+
+    {
+        const std::lock_guard lock(m_mutex);
+        m_stopping = true;
+        m_drain = drain;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+} // namespace LE
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LE {
+
+// UTF-8 output sink with write-behind.
+// Text is encoded into large reusable buffers; full buffers are handed to a
+// background thread that writes them to the device, so encoding and disk
+// writes overlap. The thread is only started once the first buffer fills up —
+// small outputs are written synchronously by finish().
+//
+// Line endings follow the platform convention (CRLF on Windows), matching what
+// a QIODevice::Text stream produced before.
+//
+// Write errors surface as std::runtime_error from the next append or from
+// finish(). Destroying the writer without finish() discards pending buffers.
+class OutputWriter {
+public:
+    static constexpr qsizetype kDefaultBufferSize = qsizetype(1) << 20;  // 1 MiB
+    static constexpr int       kBufferCount       = 4;
+
+    explicit OutputWriter(QIODevice& device, qsizetype bufferSize = kDefaultBufferSize);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    void append(QStringView text);
+    void appendUtf8(QByteArrayView bytes);
+
+    void append(char ascii)
+    {
+        if (m_current->size == m_capacity) submitCurrent();
+        m_current->data[m_current->size++] = ascii;
+    }
+
+    void endLine()
+    {
+#ifdef Q_OS_WIN
+        append('\r');
+#endif
+        append('\n');
+    }
+
+    // Writes everything still buffered and waits for the background thread.
+    void finish();
+
+    // Bytes handed to the device so far (complete once finish() returns).
+    [[nodiscard]] qint64 bytesWritten() const noexcept { return m_bytesSubmitted; }
+
+    // Time spent in device writes, on whichever thread made them. Timed once
+    // per buffer. Complete once finish() returns.
+    [[nodiscard]] qint64 deviceNanoseconds() const noexcept { return m_deviceNs; }
+
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        qsizetype size = 0;
+    };
+
+    void submitCurrent();
+    std::optional<std::string> writeTimed(const char* data, qsizetype size);
+    void writerLoop();
+    void throwIfFailed();
+    void stopThread(bool drain);
+
+    QIODevice&     m_device;
+    qsizetype      m_capacity;
+    QStringEncoder m_encoder{QStringConverter::Utf8};
+    qint64         m_bytesSubmitted = 0;
+    qint64         m_deviceNs = 0;        // Only touched by the thread writing
+
+    std::vector<Buffer> m_storage;
+    Buffer*             m_current = nullptr;
+
+    // Shared with the writer thread.
+    std::mutex                 m_mutex;
+    std::condition_variable    m_cv;
+    std::deque<Buffer*>        m_full;
+    std::deque<Buffer*>        m_free;
+    std::optional<std::string> m_error;
+    bool                       m_stopping = false;
+    bool                       m_drain    = true;
+    std::thread                m_thread;
+};
+
+// In-memory sink with the same append interface as OutputWriter.
+// Used by parallel workers to build one chunk of output that is later passed
+// to OutputWriter::appendUtf8() in input order.
+class MemorySink {
+public:
+    void append(QStringView text)
+    {
+        const qsizetype start = m_bytes.size();
+        m_bytes.resize(start + m_encoder.requiredSpace(text.size()));
+        char* const end = m_encoder.appendToBuffer(m_bytes.data() + start, text);
+        m_bytes.resize(end - m_bytes.constData());
+    }
+
+    void appendUtf8(QByteArrayView bytes) { m_bytes.append(bytes); }
+    void append(char ascii) { m_bytes.append(ascii); }
+
+    void endLine()
+    {
+#ifdef Q_OS_WIN
+        append('\r');
+#endif
+        append('\n');
+    }
+
+    // Empties the sink but keeps its allocation for the next chunk.
+    void clear()
+    {
+        m_bytes.resize(0);
+        m_encoder.resetState();
+    }
+    [[nodiscard]] const QByteArray& bytes() const noexcept { return m_bytes; }
+
+private:
+    QByteArray     m_bytes;
+    QStringEncoder m_encoder{QStringConverter::Utf8};
+};
+
+} // namespace LE
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace LE {
+
+// Runs fn(0) … fn(count - 1) on `pool` (the global pool by default), with
+// the calling thread taking part. Helpers that have not started by the time
+// the work runs out are withdrawn with tryTake(), so this never waits on a
+// saturated pool and may be nested.
+//
+// If fn throws, no further index is handed out; the first exception is
+// rethrown on the calling thread once every helper has returned, as they
+// all use this stack frame.
+template <typename Fn>
+void parallelFor(int count, Fn&& fn, QThreadPool* pool = QThreadPool::globalInstance())
+{
+    std::atomic<int>   next{0};
+    std::mutex         errorMutex;
+    std::exception_ptr error;
+
+    const auto fail = [&]() noexcept {
+        next.store(count);
+        const std::lock_guard lock(errorMutex);
+        if (!error) error = std::current_exception();
+    };
+    const auto drain = [&]() noexcept {
+        try {
+            for (int i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        } catch (...) {
+            fail();
+        }
+    };
+
+    const int helperCount = std::min(count, pool->maxThreadCount()) - 1;
+
+    QSemaphore finished;
+    std::vector<std::unique_ptr<QRunnable>> helpers;
+    helpers.reserve(std::max(helperCount, 0));
+
+    try {
+        for (int h = 0; h < helperCount; ++h) {
+            std::unique_ptr<QRunnable> helper(QRunnable::create([&] {
+                drain();
+                finished.release();
+            }));
+            helper->setAutoDelete(false);
+            pool->start(helper.get());
+            helpers.push_back(std::move(helper));
+        }
+    } catch (...) {
+        fail();
+    }
+
+    drain();
+
+    int running = static_cast<int>(helpers.size());
+    for (const auto& helper : helpers) {
+        if (pool->tryTake(helper.get())) {
+            --running;
+        }
+    }
+    finished.acquire(running);
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace LE
@@ -0,0 +1,344 @@
+#include "PathKernels.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LE_PATHKERNELS_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#else
+#  define LE_PATHKERNELS_X86 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions that opt in;
+// MSVC allows the intrinsics anywhere.
+#if LE_PATHKERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+#  define LE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define LE_TARGET_AVX2
+#endif
+
+namespace LE::PathKernels {
+
+namespace {
+
+constexpr char16_t kSlash     = u'/';
+constexpr char16_t kBackslash = u'\\';
+
+// Scalar step shared by every implementation, for UTF-16 code units and UTF-8
+// bytes alike. `lastWasSep` carries the separator state across calls so vector
+// loops can hand over any block.
+template <typename Char>
+inline Char* collapseRange(const Char* in, qsizetype size, Char* out, bool& lastWasSep) noexcept
+{
+    for (qsizetype i = 0; i < size; ++i) {
+        const Char ch = in[i];
+        if (ch == Char(kSlash) || ch == Char(kBackslash)) {
+            if (!lastWasSep) {
+                *out++ = Char(kBackslash);
+            }
+            lastWasSep = true;
+        } else {
+            *out++ = ch;
+            lastWasSep = false;
+        }
+    }
+    return out;
+}
+
+// Runs are already collapsed, so at most one trailing separator remains.
+template <typename Char>
+inline qsizetype finish(const Char* begin, const Char* end) noexcept
+{
+    if (end != begin && end[-1] == Char(kBackslash)) {
+        --end;
+    }
+    return end - begin;
+}
+
+#if LE_PATHKERNELS_X86
+
+// ─── SSE2: 8 code units per step ─────────────────────────────────────────────
+// Blocks without separators are copied; blocks whose separators are all
+// isolated get '/' rewritten to '\' in-register. Only blocks containing a
+// run of separators fall back to the scalar step.
+
+qsizetype collapseSse2(const char16_t* in, qsizetype size, char16_t* out) noexcept
+{
+    const __m128i slash     = _mm_set1_epi16(static_cast<short>(kSlash));
+    const __m128i backslash = _mm_set1_epi16(static_cast<short>(kBackslash));
+    const __m128i zero      = _mm_setzero_si128();
+
+    char16_t* o = out;
+    bool lastWasSep = false;
+    qsizetype i = 0;
+
+    // Stores of 8 units at `o` stay within [out, out + size) because o <= out + i.
+    for (; i + 8 <= size; i += 8) {
+        const __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i sep = _mm_or_si128(_mm_cmpeq_epi16(v, slash), _mm_cmpeq_epi16(v, backslash));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(sep, zero)));
+
+        if (mask == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), v);
+            o += 8;
+            lastWasSep = false;
+            continue;
+        }
+
+        const unsigned repeated = mask & ((mask << 1) | unsigned(lastWasSep));
+        if (repeated == 0) {
+            const __m128i fixed = _mm_or_si128(_mm_andnot_si128(sep, v), _mm_and_si128(sep, backslash));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), fixed);
+            o += 8;
+            lastWasSep = (mask >> 7) & 1u;
+            continue;
+        }
+
+        o = collapseRange(in + i, 8, o, lastWasSep);
+    }
+
+    o = collapseRange(in + i, size - i, o, lastWasSep);
+    return finish(out, o);
+}
+
+// Byte variant for UTF-8: 16 bytes per step, same classification.
+qsizetype collapseSse2(const char* in, qsizetype size, char* out) noexcept
+{
+    const __m128i slash     = _mm_set1_epi8(static_cast<char>(kSlash));
+    const __m128i backslash = _mm_set1_epi8(static_cast<char>(kBackslash));
+
+    char* o = out;
+    bool lastWasSep = false;
+    qsizetype i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i sep = _mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_cmpeq_epi8(v, backslash));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(sep));
+
+        if (mask == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), v);
+            o += 16;
+            lastWasSep = false;
+            continue;
+        }
+
+        const unsigned repeated = mask & ((mask << 1) | unsigned(lastWasSep));
+        if (repeated == 0) {
+            const __m128i fixed = _mm_or_si128(_mm_andnot_si128(sep, v), _mm_and_si128(sep, backslash));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), fixed);
+            o += 16;
+            lastWasSep = (mask >> 15) & 1u;
+            continue;
+        }
+
+        o = collapseRange(in + i, 16, o, lastWasSep);
+    }
+
+    o = collapseRange(in + i, size - i, o, lastWasSep);
+    return finish(out, o);
+}
+
+// ─── AVX2: 16 code units per step ────────────────────────────────────────────
+// Same classification as SSE2, but runs of separators are compacted with a
+// byte shuffle per 8-unit half instead of falling back to scalar code.
+
+// For each 8-bit keep mask, a pshufb control that packs the kept 16-bit lanes
+// to the front of the register.
+struct CompactTable {
+    alignas(16) std::uint8_t control[256][16];
+};
+
+constexpr CompactTable makeCompactTable()
+{
+    CompactTable table{};
+    for (int keep = 0; keep < 256; ++keep) {
+        int k = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            if (keep & (1 << lane)) {
+                table.control[keep][2 * k]     = static_cast<std::uint8_t>(2 * lane);
+                table.control[keep][2 * k + 1] = static_cast<std::uint8_t>(2 * lane + 1);
+                ++k;
+            }
+        }
+        for (int b = 2 * k; b < 16; ++b) {
+            table.control[keep][b] = 0x80;
+        }
+    }
+    return table;
+}
+
+constexpr CompactTable kCompactTable = makeCompactTable();
+
+LE_TARGET_AVX2
+inline char16_t* storeCompacted(char16_t* o, __m128i v, unsigned keep) noexcept
+{
+    const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(kCompactTable.control[keep]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_shuffle_epi8(v, control));
+    return o + std::popcount(keep);
+}
+
+LE_TARGET_AVX2
+qsizetype collapseAvx2(const char16_t* in, qsizetype size, char16_t* out) noexcept
+{
+    const __m256i slash     = _mm256_set1_epi16(static_cast<short>(kSlash));
+    const __m256i backslash = _mm256_set1_epi16(static_cast<short>(kBackslash));
+    const __m256i zero      = _mm256_setzero_si256();
+
+    char16_t* o = out;
+    bool lastWasSep = false;
+    qsizetype i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        const __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i sep = _mm256_or_si256(_mm256_cmpeq_epi16(v, slash), _mm256_cmpeq_epi16(v, backslash));
+
+        // packs works per 128-bit lane: units 0–7 land in bits 0–7, units 8–15 in bits 16–23.
+        const unsigned packed = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_packs_epi16(sep, zero)));
+        const unsigned mask   = (packed & 0xFFu) | ((packed >> 8) & 0xFF00u);
+
+        if (mask == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), v);
+            o += 16;
+            lastWasSep = false;
+            continue;
+        }
+
+        const __m256i fixed = _mm256_blendv_epi8(v, backslash, sep);
+        const unsigned repeated = mask & ((mask << 1) | unsigned(lastWasSep));
+        lastWasSep = (mask >> 15) & 1u;
+
+        if (repeated == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), fixed);
+            o += 16;
+            continue;
+        }
+
+        const unsigned keep = ~repeated & 0xFFFFu;
+        o = storeCompacted(o, _mm256_castsi256_si128(fixed), keep & 0xFFu);
+        o = storeCompacted(o, _mm256_extracti128_si256(fixed, 1), keep >> 8);
+    }
+
+    o = collapseRange(in + i, size - i, o, lastWasSep);
+    return finish(out, o);
+}
+
+// Byte variant for UTF-8: 32 bytes per step. Runs of separators are rare
+// enough in real paths that their blocks simply take the scalar step.
+LE_TARGET_AVX2
+qsizetype collapseAvx2(const char* in, qsizetype size, char* out) noexcept
+{
+    const __m256i slash     = _mm256_set1_epi8(static_cast<char>(kSlash));
+    const __m256i backslash = _mm256_set1_epi8(static_cast<char>(kBackslash));
+
+    char* o = out;
+    bool lastWasSep = false;
+    qsizetype i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i sep = _mm256_or_si256(_mm256_cmpeq_epi8(v, slash), _mm256_cmpeq_epi8(v, backslash));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(sep));
+
+        if (mask == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), v);
+            o += 32;
+            lastWasSep = false;
+            continue;
+        }
+
+        const std::uint32_t repeated = mask & ((mask << 1) | std::uint32_t(lastWasSep));
+        if (repeated == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), _mm256_blendv_epi8(v, backslash, sep));
+            o += 32;
+            lastWasSep = (mask >> 31) & 1u;
+            continue;
+        }
+
+        o = collapseRange(in + i, 32, o, lastWasSep);
+    }
+
+    o = collapseRange(in + i, size - i, o, lastWasSep);
+    return finish(out, o);
+}
+
+bool cpuHasAvx2() noexcept
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // AVX needs OS support for saving YMM state (OSXSAVE + XCR0 bits 1 and 2).
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // LE_PATHKERNELS_X86
+
+} // namespace
+
+std::vector<Implementation> implementations()
+{
+    std::vector<Implementation> list{{"scalar", collapseSeparatorsScalar, collapseSeparatorsScalar}};
+#if LE_PATHKERNELS_X86
+    list.push_back({"sse2", collapseSse2, collapseSse2});
+    if (cpuHasAvx2()) {
+        list.push_back({"avx2", collapseAvx2, collapseAvx2});
+    }
+#endif
+    return list;
+}
+
+namespace {
+
+const Implementation& selectedKernel() noexcept
+{
+    static const Implementation kernel = implementations().back();
+    return kernel;
+}
+
+} // namespace
+
+qsizetype collapseSeparators(const char16_t* in, qsizetype size, char16_t* out) noexcept
+{
+    return selectedKernel().utf16(in, size, out);
+}
+
+qsizetype collapseSeparators(const char* in, qsizetype size, char* out) noexcept
+{
+    return selectedKernel().utf8(in, size, out);
+}
+
+qsizetype collapseSeparatorsScalar(const char16_t* in, qsizetype size, char16_t* out) noexcept
+{
+    bool lastWasSep = false;
+    return finish(out, collapseRange(in, size, out, lastWasSep));
+}
+
+qsizetype collapseSeparatorsScalar(const char* in, qsizetype size, char* out) noexcept
+{
+    bool lastWasSep = false;
+    return finish(out, collapseRange(in, size, out, lastWasSep));
+}
+
+const char* activeKernelName() noexcept
+{
+    return selectedKernel().name;
+}
+
+} // namespace LE::PathKernels
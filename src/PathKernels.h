@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+namespace LE::PathKernels {
+
+// Separator normalization on raw UTF-16 code units, the core of
+// Converter::normalizePath(). Every run of '/' and '\' is collapsed to a
+// single '\' and one trailing separator is stripped.
+//
+// `out` must have room for `size` code units and must not overlap `in`.
+// Returns the number of code units written.
+//
+// The implementation is chosen once at runtime: AVX2, SSE2 or scalar.
+qsizetype collapseSeparators(const char16_t* in, qsizetype size, char16_t* out) noexcept;
+
+// The same operation on UTF-8 bytes. Separators are ASCII, and UTF-8 never
+// uses bytes below 0x80 inside a multi-byte sequence, so working byte-wise
+// is exact. Same contract as above, in bytes.
+qsizetype collapseSeparators(const char* in, qsizetype size, char* out) noexcept;
+
+// Reference implementations. Exposed so the vector paths can be checked against them.
+qsizetype collapseSeparatorsScalar(const char16_t* in, qsizetype size, char16_t* out) noexcept;
+qsizetype collapseSeparatorsScalar(const char* in, qsizetype size, char* out) noexcept;
+
+// Name of the implementation selected for this CPU ("avx2", "sse2" or "scalar").
+const char* activeKernelName() noexcept;
+
+// Both variants of one implementation.
+struct Implementation {
+    const char* name;
+    qsizetype (*utf16)(const char16_t* in, qsizetype size, char16_t* out) noexcept;
+    qsizetype (*utf8)(const char* in, qsizetype size, char* out) noexcept;
+};
+
+// Every implementation this CPU can run: the scalar reference first, the one
+// collapseSeparators() uses last. Lets tests check each vector path, not just
+// the selected one.
+std::vector<Implementation> implementations();
+
+} // namespace LE::PathKernels
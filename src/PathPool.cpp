@@ -0,0 +1,68 @@
+#include "PathPool.h"
+
+#include <QHashFunctions>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace LE {
+
+namespace {
+
+constexpr std::size_t kMinSlots = 256;
+
+} // namespace
+
+PathPool::Id PathPool::intern(QByteArrayView text)
+{
+    if (m_last != kNone && text == this->text(m_last)) {
+        return m_last;
+    }
+
+    // Load factor at most 1/2 keeps probe sequences short.
+    if ((m_ends.size() + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+
+    const std::size_t hash = qHashBits(text.data(), static_cast<std::size_t>(text.size()));
+    const std::size_t mask = m_slots.size() - 1;
+
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+        if (slot.id == kNone) {
+            constexpr auto kMax = std::numeric_limits<std::uint32_t>::max();
+            if (m_ends.size() >= kMax - 1 || static_cast<quint64>(m_text.size() + text.size()) > kMax) {
+                throw std::runtime_error("Path pool is full: more than 4 GiB of distinct fragments.");
+            }
+            m_text.append(text);
+            m_ends.push_back(static_cast<std::uint32_t>(m_text.size()));
+            slot = {hash, static_cast<Id>(m_ends.size() - 1)};
+            return m_last = slot.id;
+        }
+        if (slot.hash == hash && this->text(slot.id) == text) {
+            return m_last = slot.id;
+        }
+    }
+}
+
+// Slots keep their hash, so growing never touches the text.
+void PathPool::grow()
+{
+    std::vector<Slot> slots(std::max(kMinSlots, m_slots.size() * 2));
+    const std::size_t mask = slots.size() - 1;
+
+    for (const Slot& slot : m_slots) {
+        if (slot.id == kNone) continue;
+
+        std::size_t i = slot.hash & mask;
+        while (slots[i].id != kNone) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+    m_slots = std::move(slots);
+}
+
+} // namespace LE
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LE {
+
+// Intern table for path fragments that repeat across many entries, such as
+// album directories. Each distinct fragment is stored once, back to back in
+// one byte arena, and numbered densely in the order it was first seen, so a
+// caller can hold a 4-byte id instead of the text.
+//
+// Consecutive entries of a playlist usually come from the same directory;
+// interning the fragment that was interned last costs one comparison.
+// Not thread-safe.
+class PathPool {
+public:
+    using Id = std::uint32_t;
+
+    // Returns the id of `text`, adding it on first use.
+    // Throws std::runtime_error once the fragments would exceed 4 GiB.
+    Id intern(QByteArrayView text);
+
+    [[nodiscard]] QByteArrayView text(Id id) const noexcept
+    {
+        const qsizetype begin = (id == 0) ? 0 : m_ends[id - 1];
+        return QByteArrayView(m_text).sliced(begin, m_ends[id] - begin);
+    }
+
+    [[nodiscard]] qsizetype size() const noexcept { return static_cast<qsizetype>(m_ends.size()); }
+    [[nodiscard]] qsizetype bytes() const noexcept { return m_text.size(); }
+
+private:
+    static constexpr Id kNone = ~Id(0);
+
+    struct Slot {
+        std::size_t hash = 0;
+        Id          id   = kNone;
+    };
+
+    void grow();
+
+    std::vector<Slot>          m_slots;
+    QByteArray                 m_text;
+    std::vector<std::uint32_t> m_ends;      // End offset of each fragment in m_text
+    Id                         m_last = kNone;
+};
+
+} // namespace LE
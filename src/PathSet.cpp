@@ -0,0 +1,90 @@
+#include "PathSet.h"
+#include "Converter.h"
+#include "Utf8.h"
+
+#include <QString>
+
+#include <algorithm>
+#include <utility>
+
+namespace LE {
+
+namespace {
+
+constexpr std::size_t kMinSlots = 1024;
+
+// Final mix of SplitMix64: ids are dense, so their bits need spreading.
+std::size_t mix(std::uint64_t x) noexcept
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<std::size_t>(x ^ (x >> 31));
+}
+
+} // namespace
+
+void PathSet::appendKey(QByteArrayView path, QByteArray& out)
+{
+    const qsizetype start = out.size();
+    Converter::normalizePathInto(path, out);
+
+    const QByteArrayView normalized = QByteArrayView(out).sliced(start);
+    if (Utf8::isAscii(normalized)) {
+        char* p = out.data() + start;
+        char* const end = out.data() + out.size();
+        for (; p != end; ++p) {
+            if (*p >= 'A' && *p <= 'Z') {
+                *p = static_cast<char>(*p + ('a' - 'A'));
+            }
+        }
+        return;
+    }
+
+    const QByteArray folded = QString::fromUtf8(normalized).toCaseFolded().toUtf8();
+    out.truncate(start);
+    out.append(folded);
+}
+
+bool PathSet::insert(QByteArrayView key)
+{
+    const qsizetype sep = key.lastIndexOf('\\');
+    const PathPool::Id directory = m_directories.intern(key.first(sep + 1));
+    const PathPool::Id name      = m_names.intern(key.sliced(sep + 1));
+    const std::uint64_t pair = (std::uint64_t(directory) << 32) | name;
+
+    // Load factor at most 1/2 keeps probe sequences short.
+    if (static_cast<std::size_t>(m_size + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = mix(pair) & mask;; i = (i + 1) & mask) {
+        if (m_slots[i] == kEmpty) {
+            m_slots[i] = pair;
+            ++m_size;
+            return true;
+        }
+        if (m_slots[i] == pair) {
+            return false;
+        }
+    }
+}
+
+void PathSet::grow()
+{
+    std::vector<std::uint64_t> slots(std::max(kMinSlots, m_slots.size() * 2), kEmpty);
+    const std::size_t mask = slots.size() - 1;
+
+    for (const std::uint64_t pair : m_slots) {
+        if (pair == kEmpty) continue;
+
+        std::size_t i = mix(pair) & mask;
+        while (slots[i] != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = pair;
+    }
+    m_slots = std::move(slots);
+}
+
+} // namespace LE
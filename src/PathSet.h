@@ -0,0 +1,45 @@
+#pragma once
+
+#include "PathPool.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <cstdint>
+#include <vector>
+
+namespace LE {
+
+// Set of file paths with Windows semantics: two paths are the same if they
+// are equal after Converter::normalizePath, ignoring case.
+//
+// Built for millions of entries: each key is split at its last separator,
+// the directory and the file name are interned in a PathPool each, and the
+// set holds the pair of their ids in an open-addressing table. An album
+// directory is stored once for all of its tracks, so memory follows the
+// distinct file names rather than the full paths, and the set makes a
+// handful of allocations over its lifetime.
+class PathSet {
+public:
+    // Appends the comparison key of a UTF-8 `path` to `out`: separators
+    // collapsed to single backslashes, then case folded. ASCII paths are
+    // folded in place; others are decoded for Unicode case folding.
+    static void appendKey(QByteArrayView path, QByteArray& out);
+
+    // Adds a key made by appendKey(). Returns false if it was already there.
+    bool insert(QByteArrayView key);
+
+    [[nodiscard]] qsizetype size() const noexcept { return m_size; }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+
+    void grow();
+
+    PathPool                   m_directories;   // Up to the last backslash of each key
+    PathPool                   m_names;         // The rest
+    std::vector<std::uint64_t> m_slots;         // Directory id << 32 | name id, or kEmpty
+    qsizetype                  m_size = 0;
+};
+
+} // namespace LE
@@ -0,0 +1,137 @@
+#include "PathValidator.h"
+#include "Parallel.h"
+#include "Logger.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+namespace LE {
+
+namespace {
+
+// Windows file names are case-insensitive.
+QString foldCase(const QString& name)
+{
+#ifdef Q_OS_WIN
+    return name.toCaseFolded();
+#else
+    return name;
+#endif
+}
+
+struct SplitPath {
+    QString directory;      // Absolute, '/' separators, folded
+    QString name;           // Folded
+};
+
+// Splits a converted entry ("D:\Music\Album\01.mp3", "Album\01.mp3",
+// "C:01.mp3") into its directory and file name.
+SplitPath splitPath(const QDir& base, const QString& path)
+{
+    const QString native = QDir::fromNativeSeparators(path);
+    qsizetype sep = native.lastIndexOf(u'/');
+
+    QString directory;
+    if (sep >= 0) {
+        // Keep the root separator: "D:/x" lives in "D:/", "/x" in "/".
+        directory = native.first((sep == 0 || (sep == 2 && native[1] == u':')) ? sep + 1 : sep);
+    } else if (native.size() >= 2 && native[1] == u':') {
+        directory = native.first(2);
+        sep = 1;
+    }
+
+    return {foldCase(QDir::cleanPath(base.absoluteFilePath(directory))), foldCase(native.sliced(sep + 1))};
+}
+
+} // namespace
+
+PathValidator::PathValidator(const QString& baseDir)
+    : m_baseDir(baseDir)
+{
+    m_pool.setMaxThreadCount(kListingThreads);
+}
+
+void PathValidator::check(const Playlist& lines, QByteArrayView prefix, std::vector<char>& found)
+{
+    const QDir base(m_baseDir);
+    found.assign(static_cast<std::size_t>(lines.size()), 1);
+
+    // Resolve every entry and collect the directories of this batch.
+    std::vector<SplitPath> paths(static_cast<std::size_t>(lines.size()));
+    QHash<QString, Listing> batchListings;
+    QByteArray full;
+
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        if (!lines.isEntry(i)) continue;
+
+        full.resize(0);
+        if (lines.kind(i) == Playlist::Kind::Entry) {
+            full.append(prefix);
+        }
+        full.append(lines.text(i));
+
+        SplitPath& path = paths[static_cast<std::size_t>(i)];
+        path = splitPath(base, QString::fromUtf8(full));
+        batchListings.insert(path.directory, nullptr);
+    }
+
+    // Take what is cached; the rest still has to be listed.
+    QStringList pending;
+    {
+        const QMutexLocker lock(&m_mutex);
+        for (auto it = batchListings.begin(); it != batchListings.end(); ++it) {
+            if (const auto cached = m_listings.constFind(it.key()); cached != m_listings.cend()) {
+                it.value() = *cached;
+            } else {
+                pending.append(it.key());
+            }
+        }
+    }
+
+    // List the new directories in parallel, outside the lock. Two workers may
+    // occasionally list the same directory; the first result is kept.
+    if (!pending.isEmpty()) {
+        std::vector<Listing> listed(static_cast<std::size_t>(pending.size()));
+        parallelFor(static_cast<int>(pending.size()), [&](int i) {
+            listed[static_cast<std::size_t>(i)] = listDirectory(pending[i]);
+        }, &m_pool);
+
+        const QMutexLocker lock(&m_mutex);
+        for (qsizetype i = 0; i < pending.size(); ++i) {
+            auto cached = m_listings.find(pending[i]);
+            if (cached == m_listings.end()) {
+                cached = m_listings.insert(pending[i], listed[static_cast<std::size_t>(i)]);
+            }
+            batchListings[pending[i]] = *cached;
+        }
+    }
+
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        if (!lines.isEntry(i)) continue;
+
+        const SplitPath& path = paths[static_cast<std::size_t>(i)];
+        const Listing& listing = batchListings[path.directory];
+        found[static_cast<std::size_t>(i)] = listing && listing->contains(path.name);
+    }
+}
+
+PathValidator::Listing PathValidator::listDirectory(const QString& dir)
+{
+    ++m_listed;
+
+    if (!QFileInfo(dir).isDir()) {
+        qCDebug(lcConverter) << "Validation: directory not found:" << dir;
+        return nullptr;
+    }
+
+    auto names = std::make_shared<QSet<QString>>();
+    QDirIterator it(dir, QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        it.next();
+        names->insert(foldCase(it.fileName()));
+    }
+    return names;
+}
+
+} // namespace LE
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Playlist.h"
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace LE {
+
+// Checks whether converted entries exist (ValidationMode::Report / Drop).
+// Rather than stat'ing every file, each directory is listed once and the
+// listing is cached for the rest of the conversion; the directories first
+// seen in a batch are listed in parallel. On a network share this turns one
+// round trip per entry into one per album folder.
+//
+// Thread-safe: chunked conversions check batches from several workers.
+class PathValidator {
+public:
+    // Listing is bound by I/O latency, not CPU, so it uses more threads than cores.
+    static constexpr int kListingThreads = 16;
+
+    // Relative entries are resolved against `baseDir`.
+    explicit PathValidator(const QString& baseDir);
+
+    // Sets found[i] for every line of `lines`; directives always count as found.
+    // `prefix` is written in front of every Kind::Entry line in the output (UTF-8).
+    void check(const Playlist& lines, QByteArrayView prefix, std::vector<char>& found);
+
+    [[nodiscard]] qint64 directoriesListed() const noexcept { return m_listed.load(); }
+
+private:
+    // File names in one directory, folded where the file system ignores case;
+    // null if the directory does not exist or cannot be read.
+    using Listing = std::shared_ptr<const QSet<QString>>;
+
+    Listing listDirectory(const QString& dir);
+
+    QString     m_baseDir;
+    QThreadPool m_pool;
+
+    QMutex                  m_mutex;
+    QHash<QString, Listing> m_listings;     // Keyed by folded absolute directory
+    std::atomic<qint64>     m_listed{0};
+};
+
+} // namespace LE
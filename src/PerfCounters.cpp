@@ -0,0 +1,69 @@
+#include "PerfCounters.h"
+#include "Logger.h"
+
+// Info messages are off unless enabled, e.g. QT_LOGGING_RULES="le.perf.info=true".
+Q_LOGGING_CATEGORY(lcPerf, "le.perf", QtWarningMsg)
+
+namespace LE {
+
+namespace {
+
+double toMs(qint64 ns)
+{
+    return static_cast<double>(ns) / 1e6;
+}
+
+// MB per second of wall time.
+double throughput(qint64 bytes, qint64 ns)
+{
+    return ns > 0 ? static_cast<double>(bytes) * 1e3 / static_cast<double>(ns) : 0.0;
+}
+
+} // namespace
+
+PerfCounters& PerfCounters::operator+=(const PerfCounters& other) noexcept
+{
+    linesRead    += other.linesRead;
+    linesSkipped += other.linesSkipped;
+    bytesIn      += other.bytesIn;
+    bytesOut     += other.bytesOut;
+    readNs       += other.readNs;
+    filterNs     += other.filterNs;
+    transformNs  += other.transformNs;
+    writeNs      += other.writeNs;
+    deviceNs     += other.deviceNs;
+    wallNs       += other.wallNs;
+    return *this;
+}
+
+void PerfCounters::log(const QString& outputPath) const
+{
+    qCInfo(lcPerf).noquote()
+        << outputPath << '(' + execution + "):"
+        << linesRead << "lines read," << linesSkipped << "skipped,"
+        << bytesIn << "bytes in," << bytesOut << "bytes out;"
+        << "read" << toMs(readNs) << "ms, filter" << toMs(filterNs)
+        << "ms, transform" << toMs(transformNs) << "ms, write" << toMs(writeNs)
+        << "ms, device" << toMs(deviceNs) << "ms, wall" << toMs(wallNs) << "ms,"
+        << throughput(bytesIn, wallNs) << "MB/s";
+}
+
+QJsonObject PerfCounters::toJson() const
+{
+    return QJsonObject{
+        {"execution",    execution},
+        {"linesRead",    linesRead},
+        {"linesSkipped", linesSkipped},
+        {"bytesIn",      bytesIn},
+        {"bytesOut",     bytesOut},
+        {"readMs",       toMs(readNs)},
+        {"filterMs",     toMs(filterNs)},
+        {"transformMs",  toMs(transformNs)},
+        {"writeMs",      toMs(writeNs)},
+        {"deviceMs",     toMs(deviceNs)},
+        {"wallMs",       toMs(wallNs)},
+        {"mbPerSecond",  throughput(bytesIn, wallNs)},
+    };
+}
+
+} // namespace LE
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+
+namespace LE {
+
+// Where the time of a conversion goes, stage by stage, to tell I/O-bound
+// jobs from CPU-bound ones. Collected only when ConversionParams::perfReport
+// is set or the le.perf category logs info messages; otherwise every stage
+// skips the measurements.
+//
+// Stages count once per batch of lines, never per line. Stage times are
+// summed over the threads that ran the stage, so with the threaded or
+// chunked execution they can add up to more than the wall time.
+struct PerfCounters {
+    QString execution;          // Pipeline execution that ran
+
+    qint64 linesRead    = 0;
+    qint64 linesSkipped = 0;    // Blank lines, and directives unless kept
+    qint64 bytesIn      = 0;    // Input file size
+    qint64 bytesOut     = 0;    // Output file size
+
+    qint64 readNs      = 0;     // Slicing the mapped input into lines, page faults included
+    qint64 filterNs    = 0;     // Decoding and trimming lines
+    qint64 transformNs = 0;     // Transforms, validation and dedup
+    qint64 writeNs     = 0;     // Copying lines into the output buffers
+    qint64 deviceNs    = 0;     // Writing the buffers to disk, and the commit
+    qint64 wallNs      = 0;     // The whole conversion
+
+    // Adds the counts and times of another thread's counters.
+    PerfCounters& operator+=(const PerfCounters& other) noexcept;
+
+    // One summary line to le.perf.
+    void log(const QString& outputPath) const;
+
+    // Every field, times in milliseconds.
+    [[nodiscard]] QJsonObject toJson() const;
+};
+
+// Adds the time until it goes out of scope to one field of `perf`. Does
+// nothing if `perf` is null, which is how stages run with counters off.
+class StageTimer {
+public:
+    StageTimer(PerfCounters* perf, qint64 PerfCounters::*field) noexcept
+        : m_ns(perf ? &(perf->*field) : nullptr)
+    {
+        if (m_ns) m_timer.start();
+    }
+
+    ~StageTimer()
+    {
+        if (m_ns) *m_ns += m_timer.nsecsElapsed();
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    qint64*       m_ns;
+    QElapsedTimer m_timer;
+};
+
+} // namespace LE
@@ -0,0 +1,713 @@
+#include "Pipeline.h"
+#include "LineReader.h"
+#include "OutputWriter.h"
+#include "LibraryIndex.h"
+#include "Parallel.h"
+#include "PathValidator.h"
+#include "SpscQueue.h"
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <QThread>
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace LE {
+
+namespace {
+
+// Batches in flight between two stages.
+constexpr std::size_t kQueueDepth = 8;
+
+// Spent batches travelling back to the producing stage for reuse. At most
+// kQueueDepth + 2 batches of a kind ever exist, so returning never blocks.
+constexpr std::size_t kRecycleDepth = 2 * kQueueDepth;
+
+// ─── Stages ──────────────────────────────────────────────────────────────────
+
+// True if `raw` holds an entry once cleaned: neither blank nor a directive.
+bool isEntryLine(LineCleaner& cleaner, QByteArrayView raw)
+{
+    const QByteArrayView line = cleaner.clean(raw);
+    return !line.isEmpty() && !line.startsWith('#');
+}
+
+// Reader stage. Cuts the input into batches of kBatchLines lines, each
+// extended up to the next entry line, so that no batch ends in the directives
+// of an entry in the next one. The later stages drop an entry together with
+// the directives in front of it, and can only do so if both are in the same
+// batch. Only the last batch of the input may end in directives.
+//
+// Owns a LineCleaner to classify the lines past the cut, so each thread needs
+// its own instance.
+class BatchReader {
+public:
+    BatchReader(QByteArrayView data, LineReader::Bom bom, InputEncoding encoding)
+        : m_reader(data, bom)
+        , m_cleaner(encoding)
+    {}
+
+    // Returns false once the input is exhausted.
+    bool read(LineBatch& batch, PerfCounters* perf = nullptr)
+    {
+        const StageTimer timer(perf, &PerfCounters::readNs);
+        batch.lines.clear();
+
+        QByteArrayView line;
+        while (static_cast<qsizetype>(batch.lines.size()) < Pipeline::kBatchLines && m_reader.next(line)) {
+            batch.lines.push_back(line);
+        }
+        while (!batch.lines.empty() && !isEntryLine(m_cleaner, batch.lines.back()) && m_reader.next(line)) {
+            batch.lines.push_back(line);
+        }
+
+        batch.bytesEnd = m_reader.position();
+        return !batch.lines.empty();
+    }
+
+private:
+    LineReader  m_reader;
+    LineCleaner m_cleaner;
+};
+
+// Filter stage. Owns a LineCleaner, so each thread needs its own instance.
+// Whether directives are kept is settled once, by picking the loop.
+class EntryFilter {
+public:
+    explicit EntryFilter(const PipelineOptions& options) noexcept
+        : m_cleaner(options.inputEncoding)
+        , m_filterLines(options.keepDirectives ? &filterLines<true> : &filterLines<false>)
+    {}
+
+    void filter(const LineBatch& in, EntryBatch& out, PerfCounters* perf = nullptr)
+    {
+        const StageTimer timer(perf, &PerfCounters::filterNs);
+        out.clear();
+        out.bytesEnd  = in.bytesEnd;
+        out.linesRead = static_cast<qint64>(in.lines.size());
+
+        m_filterLines(m_cleaner, in, out);
+
+        if (perf) {
+            perf->linesRead    += out.linesRead;
+            perf->linesSkipped += out.linesRead - out.lines.size();
+        }
+    }
+
+private:
+    using FilterFn = void (*)(LineCleaner&, const LineBatch&, EntryBatch&);
+
+    template <bool KeepDirectives>
+    static void filterLines(LineCleaner& cleaner, const LineBatch& in, EntryBatch& out)
+    {
+        for (const QByteArrayView raw : in.lines) {
+            const QByteArrayView line = cleaner.clean(raw);
+
+            if (line.isEmpty() || (!KeepDirectives && line.startsWith('#'))) {
+                continue;
+            }
+            out.lines.appendLine(line);
+        }
+    }
+
+    LineCleaner m_cleaner;
+    FilterFn    m_filterLines;
+};
+
+// Writer stage.
+template <typename Sink>
+void writeBatch(const Playlist& lines, QByteArrayView prefix, Sink& out, PerfCounters* perf = nullptr)
+{
+    const StageTimer timer(perf, &PerfCounters::writeNs);
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        if (lines.kind(i) == Playlist::Kind::Entry) {
+            out.appendUtf8(prefix);
+        }
+        out.appendUtf8(lines.text(i));
+        out.endLine();
+    }
+}
+
+// First exception thrown by any stage thread; rethrown on the calling thread.
+class StageError {
+public:
+    void capture(std::exception_ptr error)
+    {
+        const std::lock_guard lock(m_mutex);
+        if (!m_error) m_error = std::move(error);
+    }
+
+    void rethrowIfSet()
+    {
+        const std::lock_guard lock(m_mutex);
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+private:
+    std::mutex         m_mutex;
+    std::exception_ptr m_error;
+};
+
+} // namespace
+
+// ─── JobMonitor ──────────────────────────────────────────────────────────────
+
+JobMonitor::JobMonitor(const ConversionHooks& hooks, qint64 bytesTotal)
+    : m_hooks(hooks)
+{
+    m_progress.bytesTotal = bytesTotal;
+    m_clock.start();
+}
+
+void JobMonitor::checkpoint(qint64 bytesDone, qint64 linesDone)
+{
+    if (m_hooks.isCanceled && m_hooks.isCanceled()) {
+        qCInfo(lcConverter) << "Conversion canceled after" << linesDone << "lines";
+        throw ConversionCanceled();
+    }
+
+    if (!m_hooks.progress || m_clock.elapsed() < ConversionHooks::kProgressIntervalMs) {
+        return;
+    }
+    m_clock.restart();
+    report(bytesDone, linesDone);
+}
+
+void JobMonitor::finish(qint64 linesDone)
+{
+    if (m_hooks.progress) {
+        report(m_progress.bytesTotal, linesDone);
+    }
+}
+
+void JobMonitor::reportValidation(const Playlist& missing, qint64 relinked)
+{
+    m_progress.relinkedEntries += relinked;
+    m_progress.missingEntries += missing.size();
+    if (!m_hooks.missingEntry) {
+        return;
+    }
+    for (qsizetype i = 0; i < missing.size(); ++i) {
+        m_hooks.missingEntry(QString::fromUtf8(missing.text(i)));
+    }
+}
+
+void JobMonitor::report(qint64 bytesDone, qint64 linesDone)
+{
+    m_progress.bytesDone = bytesDone;
+    m_progress.linesDone = linesDone;
+    m_hooks.progress(m_progress);
+}
+
+// ─── EntryDeduplicator ───────────────────────────────────────────────────────
+
+EntryDeduplicator::EntryDeduplicator(QByteArrayView prefix)
+    : m_prefix(prefix.toByteArray())
+{}
+
+// Most batches have no duplicate at all; lines are only copied from the
+// first one on. No batch starts among the directives of an entry (see
+// BatchReader), so the directives of a dropped entry are all in its batch.
+qint64 EntryDeduplicator::filter(Playlist& lines)
+{
+    qint64 dropped = 0;
+    qsizetype pendingFrom = 0;      // End of the kept lines before the current directives
+
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        const QByteArrayView text = lines.text(i);
+        if (!lines.isEntry(i)) {
+            if (dropped > 0) m_kept.append(Playlist::Kind::Directive, text);
+            continue;
+        }
+
+        m_path.resize(0);
+        if (lines.kind(i) == Playlist::Kind::Entry) {
+            m_path.append(m_prefix);
+        }
+        m_path.append(text);
+        m_key.resize(0);
+        PathSet::appendKey(m_path, m_key);
+
+        if (m_seen.insert(m_key)) {
+            if (dropped > 0) m_kept.append(lines.kind(i), text);
+        } else {
+            if (dropped++ == 0) {
+                m_kept.clear();
+                for (qsizetype k = 0; k < pendingFrom; ++k) {
+                    m_kept.append(lines.kind(k), lines.text(k));
+                }
+            } else {
+                m_kept.truncate(pendingFrom);
+            }
+        }
+        pendingFrom = (dropped > 0) ? m_kept.size() : i + 1;
+    }
+
+    if (dropped > 0) {
+        std::swap(lines, m_kept);
+    }
+    return dropped;
+}
+
+// ─── Pipeline ────────────────────────────────────────────────────────────────
+
+Pipeline::Pipeline(TransformKernel kernel, const PipelineOptions& options)
+    : m_kernel(kernel)
+    , m_options(options)
+    , m_outputPrefix(options.outputPrefix.toUtf8())
+{
+    Q_ASSERT(options.validation == ValidationMode::Off || options.validator);
+}
+
+Pipeline::Execution Pipeline::chooseExecution(qsizetype inputSize, bool intraFileParallel)
+{
+    const int threads = QThread::idealThreadCount();
+
+    if (intraFileParallel && inputSize >= kChunkedMinBytes && threads >= 2) {
+        return Execution::Chunked;
+    }
+    if (inputSize >= kThreadedMinBytes && threads >= 2) {
+        return Execution::Threaded;
+    }
+    return Execution::Inline;
+}
+
+QString Pipeline::executionName(Execution execution)
+{
+    switch (execution) {
+        case Execution::Inline:   return "inline";
+        case Execution::Threaded: return "threaded";
+        case Execution::Chunked:  return "chunked";
+    }
+    return {};
+}
+
+void Pipeline::run(QByteArrayView data, OutputWriter& out, JobMonitor& monitor, Execution execution) const
+{
+    switch (execution) {
+        case Execution::Inline:   runInline(data, out, monitor);   break;
+        case Execution::Threaded: runThreaded(data, out, monitor); break;
+        case Execution::Chunked:  runChunked(data, out, monitor);  break;
+    }
+}
+
+qint64 Pipeline::runChunk(QByteArrayView chunk, MemorySink& out, JobMonitor& monitor) const
+{
+    BatchReader reader(chunk, LineReader::Bom::Keep, m_options.inputEncoding);
+    LineBatch   lines;
+    EntryBatch  entries;
+    EntryBatch  converted;
+    EntryFilter filter(m_options);
+    TransformScratch scratch;
+    qint64      linesRead = 0;
+
+    while (reader.read(lines)) {
+        filter.filter(lines, entries);
+        transform(entries, converted, scratch);
+        writeBatch(converted.lines, m_outputPrefix, out);
+
+        linesRead += converted.linesRead;
+        monitor.reportValidation(converted.missing, converted.relinked);
+    }
+    return linesRead;
+}
+
+qsizetype Pipeline::entryBoundary(QByteArrayView data, qsizetype from) const
+{
+    LineReader  reader(data.sliced(from), LineReader::Bom::Keep);
+    LineCleaner cleaner(m_options.inputEncoding);
+
+    QByteArrayView raw;
+    while (reader.next(raw)) {
+        if (isEntryLine(cleaner, raw)) {
+            break;
+        }
+    }
+    return from + reader.position();
+}
+
+void Pipeline::transform(const EntryBatch& in, EntryBatch& out, TransformScratch& scratch) const
+{
+    out.clear();
+    out.bytesEnd  = in.bytesEnd;
+    out.linesRead = in.linesRead;
+
+    m_kernel(in.lines, out.lines, scratch);
+
+    if (m_options.validation != ValidationMode::Off) {
+        validate(out, scratch);
+    }
+}
+
+// Relinks every entry whose file is missing but found in the library, and
+// records the others; in Drop mode those are removed together with their
+// directives.
+void Pipeline::validate(EntryBatch& batch, TransformScratch& scratch) const
+{
+    constexpr char kMissing = 0, kRelinked = 2;
+
+    Playlist& lines = batch.lines;
+    std::vector<char>& found = scratch.found;
+    m_options.validator->check(lines, m_outputPrefix, found);
+
+    Playlist& relinks = scratch.relinks;
+    relinks.clear();
+    bool anyMissing = false;
+
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        if (found[static_cast<std::size_t>(i)]) continue;
+
+        scratch.path.resize(0);
+        scratch.path.append(m_outputPrefix);
+        scratch.path.append(lines.text(i));
+
+        if (m_options.library) {
+            const QString moved = m_options.library->relink(QString::fromUtf8(scratch.path));
+            if (!moved.isEmpty()) {
+                qCDebug(lcConverter) << "Relinked" << QString::fromUtf8(scratch.path) << "to" << moved;
+                scratch.path.resize(0);
+                Converter::normalizePathInto(moved.toUtf8(), scratch.path);
+                relinks.append(Playlist::Kind::Resolved, scratch.path);
+                found[static_cast<std::size_t>(i)] = kRelinked;
+                continue;
+            }
+        }
+
+        batch.missing.append(Playlist::Kind::Entry, scratch.path);
+        anyMissing = true;
+    }
+
+    batch.relinked = relinks.size();
+    const bool drop = anyMissing && m_options.validation == ValidationMode::Drop;
+    if (!drop && relinks.size() == 0) {
+        return;
+    }
+
+    Playlist& kept = scratch.kept;
+    kept.clear();
+    qsizetype pendingFrom = 0;
+    qsizetype relink = 0;
+
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        if (!lines.isEntry(i)) {
+            kept.append(Playlist::Kind::Directive, lines.text(i));
+            continue;
+        }
+        switch (found[static_cast<std::size_t>(i)]) {
+            case kMissing:
+                if (drop) {
+                    kept.truncate(pendingFrom);
+                } else {
+                    kept.append(lines.kind(i), lines.text(i));
+                }
+                break;
+            case kRelinked:
+                kept.append(Playlist::Kind::Resolved, relinks.text(relink++));
+                break;
+            default:
+                kept.append(lines.kind(i), lines.text(i));
+                break;
+        }
+        pendingFrom = kept.size();
+    }
+    std::swap(lines, kept);
+}
+
+void Pipeline::runInline(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const
+{
+    BatchReader reader(data, LineReader::Bom::Skip, m_options.inputEncoding);
+    LineBatch   lines;
+    EntryBatch  entries;
+    EntryBatch  converted;
+    EntryFilter filter(m_options);
+    TransformScratch scratch;
+    qint64      linesRead = 0;
+    PerfCounters* const perf = monitor.perf();
+
+    std::optional<EntryDeduplicator> dedup;
+    if (m_options.dedup) dedup.emplace(m_outputPrefix);
+
+    while (reader.read(lines, perf)) {
+        filter.filter(lines, entries, perf);
+        {
+            const StageTimer timer(perf, &PerfCounters::transformNs);
+            transform(entries, converted, scratch);
+            if (dedup) {
+                monitor.reportDuplicates(dedup->filter(converted.lines));
+            }
+        }
+        writeBatch(converted.lines, m_outputPrefix, out, perf);
+
+        linesRead += converted.linesRead;
+        monitor.reportValidation(converted.missing, converted.relinked);
+        monitor.checkpoint(converted.bytesEnd, linesRead);
+    }
+
+    monitor.finish(linesRead);
+}
+
+// Reader, filter and transform stages run on their own threads; the writer
+// stage runs on the calling thread so that progress, cancellation and write
+// errors surface where the caller expects them. A stage that stops for any
+// reason closes both of its queues, which unwinds its neighbours in turn.
+//
+// Every consumer hands its spent batch back through a recycle queue, so the
+// producer refills the same buffers instead of allocating on one thread and
+// freeing on another.
+void Pipeline::runThreaded(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const
+{
+    SpscQueue<LineBatch,  kQueueDepth> lineQueue;
+    SpscQueue<EntryBatch, kQueueDepth> entryQueue;
+    SpscQueue<EntryBatch, kQueueDepth> convertedQueue;
+
+    SpscQueue<LineBatch,  kRecycleDepth> lineRecycle;
+    SpscQueue<EntryBatch, kRecycleDepth> entryRecycle;
+    SpscQueue<EntryBatch, kRecycleDepth> convertedRecycle;
+
+    StageError stageError;
+
+    // One set of counters per stage thread, added to the monitor after the join.
+    const bool timed = monitor.perf() != nullptr;
+    PerfCounters stagePerf[3];
+    const auto perfOf = [&](int stage) { return timed ? &stagePerf[stage] : nullptr; };
+
+    const auto closeAll = [&] {
+        lineQueue.close();
+        entryQueue.close();
+        convertedQueue.close();
+    };
+
+    std::thread readerThread([&] {
+        Tracer::setThreadName("pipeline reader");
+        const TraceSpan span("read stage");
+        try {
+            BatchReader reader(data, LineReader::Bom::Skip, m_options.inputEncoding);
+            LineBatch batch;
+            PerfCounters* const perf = perfOf(0);
+            while (reader.read(batch, perf) && lineQueue.push(std::move(batch))) {
+                lineRecycle.tryPop(batch);
+            }
+        } catch (...) {
+            stageError.capture(std::current_exception());
+            closeAll();
+        }
+        lineQueue.close();
+    });
+
+    std::thread filterThread([&] {
+        Tracer::setThreadName("pipeline filter");
+        const TraceSpan span("filter stage");
+        try {
+            EntryFilter filter(m_options);
+            LineBatch lines;
+            EntryBatch entries;
+            PerfCounters* const perf = perfOf(1);
+            while (lineQueue.pop(lines)) {
+                filter.filter(lines, entries, perf);
+                lineRecycle.tryPush(std::move(lines));
+                if (!entryQueue.push(std::move(entries))) break;
+                entryRecycle.tryPop(entries);
+            }
+        } catch (...) {
+            stageError.capture(std::current_exception());
+            closeAll();
+        }
+        lineQueue.close();
+        entryQueue.close();
+    });
+
+    std::thread transformThread([&] {
+        Tracer::setThreadName("pipeline transform");
+        const TraceSpan span("transform stage");
+        try {
+            TransformScratch scratch;
+            EntryBatch entries;
+            EntryBatch converted;
+            std::optional<EntryDeduplicator> dedup;
+            if (m_options.dedup) dedup.emplace(m_outputPrefix);
+            PerfCounters* const perf = perfOf(2);
+
+            while (entryQueue.pop(entries)) {
+                {
+                    const StageTimer timer(perf, &PerfCounters::transformNs);
+                    transform(entries, converted, scratch);
+                    if (dedup) {
+                        converted.duplicates = dedup->filter(converted.lines);
+                    }
+                }
+                entryRecycle.tryPush(std::move(entries));
+                if (!convertedQueue.push(std::move(converted))) break;
+                convertedRecycle.tryPop(converted);
+            }
+        } catch (...) {
+            stageError.capture(std::current_exception());
+            closeAll();
+        }
+        entryQueue.close();
+        convertedQueue.close();
+    });
+
+    const auto joinAll = [&] {
+        readerThread.join();
+        filterThread.join();
+        transformThread.join();
+    };
+
+    qint64 linesRead = 0;
+    try {
+        const TraceSpan span("write stage");
+        EntryBatch converted;
+        while (convertedQueue.pop(converted)) {
+            writeBatch(converted.lines, m_outputPrefix, out, monitor.perf());
+            linesRead += converted.linesRead;
+            monitor.reportValidation(converted.missing, converted.relinked);
+            monitor.reportDuplicates(converted.duplicates);
+            monitor.checkpoint(converted.bytesEnd, linesRead);
+            convertedRecycle.tryPush(std::move(converted));
+        }
+    } catch (...) {
+        closeAll();
+        joinAll();
+        throw;
+    }
+
+    joinAll();
+    stageError.rethrowIfSet();
+    for (const PerfCounters& counters : stagePerf) {
+        monitor.addPerf(counters);
+    }
+    monitor.finish(linesRead);
+}
+
+// The input is cut at an entry boundary roughly every kChunkBytes. A batch of
+// chunks is converted concurrently into memory and then appended in input
+// order, while OutputWriter flushes the previous batch to disk. With dedup on,
+// the chunks are kept as lines instead and deduplicated and written during
+// the in-order append. Output is identical to the other executions.
+void Pipeline::runChunked(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const
+{
+    const qsizetype bomSize = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    data = data.sliced(bomSize);
+
+    const int threads = QThread::idealThreadCount();
+    const auto batchSize = static_cast<std::size_t>(threads) * 2;
+
+    // Per-slot working set, allocated once and reused by every batch of chunks.
+    struct Workspace {
+        explicit Workspace(const PipelineOptions& options) : filter(options) {}
+
+        LineBatch   lines;
+        EntryBatch  entries;
+        EntryBatch  converted;
+        EntryFilter filter;
+        TransformScratch scratch;
+        MemorySink  output;
+        Playlist    kept;       // With dedup: the converted lines, not yet written
+        Playlist    missing;
+        qint64      relinked  = 0;
+        qint64      lineCount = 0;
+        PerfCounters perf;
+    };
+
+    std::vector<QByteArrayView> chunks;
+    std::vector<std::unique_ptr<Workspace>> workspaces;
+    chunks.reserve(batchSize);
+    workspaces.reserve(batchSize);
+    for (std::size_t i = 0; i < batchSize; ++i) {
+        workspaces.push_back(std::make_unique<Workspace>(m_options));
+    }
+
+    std::optional<EntryDeduplicator> dedup;
+    if (m_options.dedup) dedup.emplace(m_outputPrefix);
+
+    const bool timed = monitor.perf() != nullptr;
+
+    qCDebug(lcConverter) << "Chunked conversion:" << data.size() << "bytes on" << threads << "threads";
+
+    qint64 linesRead = 0;
+    qsizetype pos = 0;
+
+    while (pos < data.size()) {
+        chunks.clear();
+        while (chunks.size() < batchSize && pos < data.size()) {
+            qsizetype end = pos + kChunkBytes;
+            if (end >= data.size()) {
+                end = data.size();
+            } else {
+                const qsizetype nl = data.indexOf('\n', end);
+                end = (nl < 0) ? data.size() : entryBoundary(data, nl + 1);
+            }
+            chunks.push_back(data.sliced(pos, end - pos));
+            pos = end;
+        }
+
+        // Each worker runs every stage inline over its chunk.
+        parallelFor(static_cast<int>(chunks.size()), [&](int i) {
+            const TraceSpan span("convert chunk");
+            const auto slot = static_cast<std::size_t>(i);
+            Workspace& ws = *workspaces[slot];
+            BatchReader reader(chunks[slot], LineReader::Bom::Keep, m_options.inputEncoding);
+            PerfCounters* const perf = timed ? &ws.perf : nullptr;
+
+            ws.output.clear();
+            ws.kept.clear();
+            ws.missing.clear();
+            ws.relinked  = 0;
+            ws.lineCount = 0;
+
+            while (reader.read(ws.lines, perf)) {
+                ws.filter.filter(ws.lines, ws.entries, perf);
+                {
+                    const StageTimer timer(perf, &PerfCounters::transformNs);
+                    transform(ws.entries, ws.converted, ws.scratch);
+                }
+                if (dedup) {
+                    const Playlist& converted = ws.converted.lines;
+                    for (qsizetype l = 0; l < converted.size(); ++l) {
+                        ws.kept.append(converted.kind(l), converted.text(l));
+                    }
+                } else {
+                    writeBatch(ws.converted.lines, m_outputPrefix, ws.output, perf);
+                }
+                ws.lineCount += ws.converted.linesRead;
+                ws.relinked  += ws.converted.relinked;
+                for (qsizetype m = 0; m < ws.converted.missing.size(); ++m) {
+                    ws.missing.append(Playlist::Kind::Entry, ws.converted.missing.text(m));
+                }
+            }
+        });
+
+        const TraceSpan appendSpan("append chunks");
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            if (dedup) {
+                {
+                    const StageTimer timer(monitor.perf(), &PerfCounters::transformNs);
+                    monitor.reportDuplicates(dedup->filter(workspaces[i]->kept));
+                }
+                writeBatch(workspaces[i]->kept, m_outputPrefix, out, monitor.perf());
+            }
+            {
+                const StageTimer timer(monitor.perf(), &PerfCounters::writeNs);
+                out.appendUtf8(workspaces[i]->output.bytes());
+            }
+            linesRead += workspaces[i]->lineCount;
+            monitor.reportValidation(workspaces[i]->missing, workspaces[i]->relinked);
+        }
+
+        // Cancellation is checked between batches of chunks. A worker that
+        // throws stops the batch; parallelFor rethrows here once all are done.
+        monitor.checkpoint(bomSize + pos, linesRead);
+    }
+
+    for (const auto& ws : workspaces) {
+        monitor.addPerf(ws->perf);
+    }
+    monitor.finish(linesRead);
+}
+
+} // namespace LE
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "Converter.h"
+#include "PathSet.h"
+#include "PerfCounters.h"
+#include "Playlist.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringView>
+
+#include <optional>
+#include <vector>
+
+namespace LE {
+
+class LibraryIndex;
+class MemorySink;
+class OutputWriter;
+class PathValidator;
+
+// ─── Batches passed between stages ───────────────────────────────────────────
+
+// Raw input lines, as views into the mapped input file. A batch never ends
+// between an entry and the directives in front of it, so every stage can
+// drop an entry with its directives without looking at the next batch.
+struct LineBatch {
+    std::vector<QByteArrayView> lines;
+    qint64 bytesEnd = 0;        // Input offset just past the last line
+};
+
+// Non-blank lines as trimmed, valid UTF-8: entries, plus the directives
+// between them when the pipeline keeps directives.
+struct EntryBatch {
+    Playlist lines;
+    Playlist missing;           // Output paths that failed validation
+    qint64   relinked  = 0;     // Entries that validation found elsewhere
+    qint64   duplicates = 0;    // Entries the dedup stage dropped
+    qint64   bytesEnd  = 0;
+    qint64   linesRead = 0;     // Input lines consumed, including skipped ones
+
+    // Keeps the allocations for reuse.
+    void clear() noexcept
+    {
+        lines.clear();
+        missing.clear();
+        relinked = 0;
+        duplicates = 0;
+        bytesEnd = 0;
+        linesRead = 0;
+    }
+};
+
+// ─── Transforms ──────────────────────────────────────────────────────────────
+
+// Per-thread scratch of the transform stage.
+struct TransformScratch {
+    QByteArray        buffers[2];
+    QByteArray        path;
+    Playlist          kept;
+    Playlist          relinks;
+    std::vector<char> found;
+};
+
+// The per-entry rewrite of a conversion (prefix stripping, normalization, …)
+// as a fixed list of steps, composed at compile time so that every direction
+// and location mode gets a loop of its own with the steps inlined and no
+// per-entry dispatch. The steps are in EntryTransforms.h. A step is a type
+// with
+//
+//   static constexpr bool kWritesBuffer;
+//   static bool apply(QByteArrayView& entry, QByteArray& buffer);
+//
+// apply() rewrites `entry` in place and returns true, or returns false to
+// drop the entry from the output. A step that writes builds its result in
+// `buffer` (empty on entry) and points `entry` at it; the others only narrow
+// `entry` and get no usable buffer. The kernel alternates the two scratch
+// buffers so that no step writes into the buffer it reads.
+//
+// Entries are valid UTF-8 and stay that way as long as a step only splits
+// them at ASCII characters, which every path rule does.
+template <typename... Steps>
+struct EntryKernel {
+    static bool apply(QByteArrayView& entry, QByteArray (&buffers)[2])
+    {
+        return applySteps<-1, Steps...>(entry, buffers);
+    }
+
+private:
+    // `Current` is the buffer `entry` points into, -1 for the input.
+    template <int Current, typename Step, typename... Rest>
+    static bool applySteps(QByteArrayView& entry, QByteArray (&buffers)[2])
+    {
+        constexpr int target = Step::kWritesBuffer ? (Current == 0 ? 1 : 0) : Current;
+        QByteArray& buffer = buffers[target < 0 ? 0 : target];
+        if constexpr (Step::kWritesBuffer) {
+            buffer.resize(0);
+        }
+        if (!Step::apply(entry, buffer)) {
+            return false;
+        }
+        if constexpr (sizeof...(Rest) == 0) {
+            return true;
+        } else {
+            return applySteps<target, Rest...>(entry, buffers);
+        }
+    }
+};
+
+// Transform stage of a conversion: one EntryKernel, picked once per
+// conversion (ConversionJob), then run over each batch with a single
+// indirect call. Shared by every worker; holds no state.
+class TransformKernel {
+public:
+    template <typename Kernel>
+    static TransformKernel of() noexcept { return TransformKernel(&run<Kernel>); }
+
+    // Appends the rewritten lines of `in` to `out`.
+    void operator()(const Playlist& in, Playlist& out, TransformScratch& scratch) const
+    {
+        m_run(in, out, scratch);
+    }
+
+private:
+    using RunFn = void (*)(const Playlist&, Playlist&, TransformScratch&);
+
+    explicit TransformKernel(RunFn run) noexcept : m_run(run) {}
+
+    // Directives are copied as they come; if the entry they precede is
+    // dropped, they are dropped with it.
+    template <typename Kernel>
+    static void run(const Playlist& in, Playlist& out, TransformScratch& scratch)
+    {
+        qsizetype pendingFrom = out.size();
+
+        for (qsizetype i = 0; i < in.size(); ++i) {
+            if (!in.isEntry(i)) {
+                out.append(Playlist::Kind::Directive, in.text(i));
+                continue;
+            }
+
+            QByteArrayView entry = in.text(i);
+            if (Kernel::apply(entry, scratch.buffers)) {
+                out.append(Playlist::Kind::Entry, entry);
+            } else {
+                out.truncate(pendingFrom);
+            }
+            pendingFrom = out.size();
+        }
+    }
+
+    RunFn m_run;
+};
+
+// ─── Job monitoring ──────────────────────────────────────────────────────────
+
+// Services ConversionHooks from the pipeline: polls for cancellation and
+// forwards progress at most once per interval. Called once per batch, so the
+// hooks cost nothing per line. Only ever used from the writing thread.
+class JobMonitor {
+public:
+    JobMonitor(const ConversionHooks& hooks, qint64 bytesTotal);
+
+    // Throws ConversionCanceled when the job has been canceled.
+    void checkpoint(qint64 bytesDone, qint64 linesDone);
+    void finish(qint64 linesDone);
+
+    // Forwards entries that failed validation to ConversionHooks::missingEntry
+    // and counts the relinked ones.
+    void reportValidation(const Playlist& missing, qint64 relinked);
+    void reportDuplicates(qint64 dropped) noexcept { m_progress.duplicateEntries += dropped; }
+
+    [[nodiscard]] qint64 missingEntries() const noexcept { return m_progress.missingEntries; }
+    [[nodiscard]] qint64 relinkedEntries() const noexcept { return m_progress.relinkedEntries; }
+    [[nodiscard]] qint64 duplicateEntries() const noexcept { return m_progress.duplicateEntries; }
+
+    // Per-stage counters, off unless enabled. Stage threads count into their
+    // own PerfCounters, which the pipeline adds here once they have joined.
+    void enablePerf() { m_perf.emplace(); }
+    [[nodiscard]] PerfCounters* perf() noexcept { return m_perf ? &*m_perf : nullptr; }
+    void addPerf(const PerfCounters& counters) noexcept { if (m_perf) *m_perf += counters; }
+
+private:
+    void report(qint64 bytesDone, qint64 linesDone);
+
+    const ConversionHooks& m_hooks;
+    ConversionProgress     m_progress;
+    QElapsedTimer          m_clock;
+    std::optional<PerfCounters> m_perf;
+};
+
+// ─── Pipeline ────────────────────────────────────────────────────────────────
+
+struct PipelineOptions {
+    // Written in front of every converted entry. Encoded once rather than
+    // copied into each entry by a transform.
+    QString outputPrefix;
+
+    // Write '#' lines out in their original place.
+    bool keepDirectives = true;
+
+    // How lines that are not valid UTF-8 are read, see LineCleaner.
+    InputEncoding inputEncoding = InputEncoding::Auto;
+
+    // Check entries against the file system; requires a validator.
+    ValidationMode validation = ValidationMode::Off;
+    PathValidator* validator  = nullptr;
+
+    // Optional: missing entries found in the library are rewritten to their
+    // new location instead of being reported.
+    const LibraryIndex* library = nullptr;
+
+    // Drop repeated entries, see EntryDeduplicator.
+    bool dedup = false;
+};
+
+// Dedup stage: drops every entry whose output path was written before,
+// comparing as Windows does (PathSet). The first occurrence keeps its place;
+// a dropped entry takes the directives in front of it along.
+// Whether an entry is a duplicate depends on everything before it, so the
+// stage sees the entries of a conversion one batch after another, in order.
+class EntryDeduplicator {
+public:
+    // Kind::Entry lines are written behind `prefix`; Kind::Resolved ones are
+    // complete paths already.
+    explicit EntryDeduplicator(QByteArrayView prefix);
+
+    // Removes the repeated entries of `lines`; returns how many.
+    qint64 filter(Playlist& lines);
+
+private:
+    QByteArray m_prefix;
+    PathSet    m_seen;
+    QByteArray m_path;
+    QByteArray m_key;
+    Playlist   m_kept;
+};
+
+// reader → filter → transforms → writer over one input file.
+//
+//   reader      slices the mapped input into LineBatches
+//   filter      validates UTF-8 (or decodes Windows-1252), trims, drops blank
+//               lines (and directives, unless they are kept)
+//   transforms  applies the TransformKernel to every entry; directives pass as is.
+//               With validation on, also checks the results against the disk
+//               and relinks moved files through the library index. With dedup
+//               on, then drops repeated entries, in input order
+//   writer      copies lines into the OutputWriter, entries behind the output prefix
+//
+// Lines stay UTF-8 from input to output; only a line that is not valid UTF-8
+// is decoded, as Windows-1252 or to repair it the way QStringDecoder does. Steady state allocates
+// nothing per line: batches are recycled between stages.
+//
+// The same stages run in one of three ways, see Execution.
+class Pipeline {
+public:
+    enum class Execution {
+        Inline,     // All stages on the calling thread, batch by batch
+        Threaded,   // One thread per stage, connected by bounded SPSC queues
+        Chunked     // Input split at line boundaries; chunks run inline on all cores
+    };
+
+    static constexpr qsizetype kBatchLines       = 4096;
+    static constexpr qsizetype kThreadedMinBytes = qsizetype(4) << 20;   // 4 MiB
+    static constexpr qsizetype kChunkedMinBytes  = qsizetype(8) << 20;   // 8 MiB
+    static constexpr qsizetype kChunkBytes       = qsizetype(1) << 20;   // 1 MiB
+
+    explicit Pipeline(TransformKernel kernel, const PipelineOptions& options = {});
+
+    // Picks the cheapest execution for an input: threads only pay off for
+    // large files, and chunking only when the caller asked for it.
+    static Execution chooseExecution(qsizetype inputSize, bool intraFileParallel);
+    static QString executionName(Execution execution);
+
+    // Converts the whole input (including a leading BOM) into `out`.
+    void run(QByteArrayView data, OutputWriter& out, JobMonitor& monitor, Execution execution) const;
+
+    // Converts a piece of an input inline, with no BOM handling, and returns
+    // the number of lines read. Pieces cut at entryBoundary() convert
+    // independently: their outputs, concatenated, equal the output of run().
+    // The dedup stage is left out, as it needs all the pieces before this one.
+    qint64 runChunk(QByteArrayView chunk, MemorySink& out, JobMonitor& monitor) const;
+
+    // Offset just past the first entry line that starts at or after `from`
+    // (a line start), or data.size(). A cut there keeps every entry in the
+    // same piece as the directives in front of it; the reader stage cuts its
+    // batches the same way, so a dropped entry takes them along.
+    qsizetype entryBoundary(QByteArrayView data, qsizetype from) const;
+
+private:
+    void runInline(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const;
+    void runThreaded(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const;
+    void runChunked(QByteArrayView data, OutputWriter& out, JobMonitor& monitor) const;
+
+    // Transform stage: rewrites every entry of `in` into `out`.
+    void transform(const EntryBatch& in, EntryBatch& out, TransformScratch& scratch) const;
+    void validate(EntryBatch& batch, TransformScratch& scratch) const;
+
+    TransformKernel m_kernel;
+    PipelineOptions m_options;
+    QByteArray      m_outputPrefix;     // UTF-8
+};
+
+} // namespace LE
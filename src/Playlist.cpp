@@ -0,0 +1,92 @@
+#include "Playlist.h"
+#include "LineReader.h"
+#include "Utf8.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace LE {
+
+// ─── Playlist ────────────────────────────────────────────────────────────────
+
+Playlist Playlist::parse(QByteArrayView data, InputEncoding encoding)
+{
+    Playlist playlist;
+    LineReader reader(data);
+    LineCleaner cleaner(encoding);
+
+    QByteArrayView raw;
+    while (reader.next(raw)) {
+        const QByteArrayView line = cleaner.clean(raw);
+        if (!line.isEmpty()) {
+            playlist.appendLine(line);
+        }
+    }
+    return playlist;
+}
+
+void Playlist::append(Kind kind, QByteArrayView text)
+{
+    const qsizetype end = m_text.size() + text.size();
+    if (end > static_cast<qsizetype>(std::numeric_limits<std::uint32_t>::max())) {
+        throw std::runtime_error("Playlist is too large (more than 4 GiB of text).");
+    }
+
+    m_text.append(text);
+    m_ends.push_back(static_cast<std::uint32_t>(end));
+    m_kinds.push_back(kind);
+    if (kind != Kind::Directive) {
+        ++m_entryCount;
+    }
+}
+
+void Playlist::truncate(qsizetype size)
+{
+    for (qsizetype i = size; i < this->size(); ++i) {
+        if (isEntry(i)) --m_entryCount;
+    }
+    m_text.resize(size == 0 ? 0 : m_ends[size - 1]);
+    m_ends.resize(static_cast<std::size_t>(size));
+    m_kinds.resize(static_cast<std::size_t>(size));
+}
+
+void Playlist::clear() noexcept
+{
+    m_text.resize(0);
+    m_ends.clear();
+    m_kinds.clear();
+    m_entryCount = 0;
+}
+
+// ─── LineCleaner ─────────────────────────────────────────────────────────────
+
+QByteArrayView LineCleaner::clean(QByteArrayView raw)
+{
+    if (m_encoding == InputEncoding::Windows1252) {
+        return Utf8::trimmed(Utf8::isAscii(raw) ? raw : fromWindows1252(raw));
+    }
+    if (Utf8::isValid(raw)) {
+        return Utf8::trimmed(raw);
+    }
+    return Utf8::trimmed(m_encoding == InputEncoding::Auto ? fromWindows1252(raw) : repair(raw));
+}
+
+QByteArrayView LineCleaner::fromWindows1252(QByteArrayView raw)
+{
+    m_repaired.resize(0);
+    Utf8::appendFromWindows1252(raw, m_repaired);
+    return m_repaired;
+}
+
+QByteArrayView LineCleaner::repair(QByteArrayView raw)
+{
+    m_decoded.resize(m_decoder.requiredSpace(raw.size()));
+    const QChar* const decodedEnd = m_decoder.appendToBuffer(m_decoded.data(), raw);
+    const QStringView text(m_decoded.constData(), decodedEnd);
+
+    m_repaired.resize(m_encoder.requiredSpace(text.size()));
+    char* const repairedEnd = m_encoder.appendToBuffer(m_repaired.data(), text);
+    return QByteArrayView(m_repaired.constData(), repairedEnd);
+}
+
+} // namespace LE
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Encoding.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringDecoder>
+#include <QStringEncoder>
+
+#include <cstdint>
+#include <vector>
+
+namespace LE {
+
+// Playlist lines in struct-of-arrays form: the text of every line back to
+// back in one shared UTF-8 buffer, plus a 4-byte end offset and a 1-byte kind
+// per line. A million-entry playlist costs little more than its text.
+//
+// Directives ('#' lines such as #EXTM3U, #EXTINF and plain comments) are kept
+// in file order, so every entry is preceded by its own directives and a
+// conversion can pass them through untouched. Blank lines are not kept.
+class Playlist {
+public:
+    enum class Kind : std::uint8_t {
+        Entry,
+        Directive,
+        Resolved        // Entry already holding its full output path (a relinked track)
+    };
+
+    // Parses playlist text with the same line rules as a conversion: a
+    // leading BOM is skipped, lines are decoded as `encoding` says (see
+    // Encoding::prepare() for UTF-16) and trimmed.
+    // Throws std::runtime_error if the text exceeds 4 GiB.
+    static Playlist parse(QByteArrayView data, InputEncoding encoding = InputEncoding::Auto);
+
+    [[nodiscard]] qsizetype size() const noexcept { return static_cast<qsizetype>(m_ends.size()); }
+    [[nodiscard]] qsizetype entryCount() const noexcept { return m_entryCount; }
+
+    [[nodiscard]] Kind kind(qsizetype i) const noexcept { return m_kinds[i]; }
+    [[nodiscard]] bool isEntry(qsizetype i) const noexcept { return m_kinds[i] != Kind::Directive; }
+
+    [[nodiscard]] QByteArrayView text(qsizetype i) const noexcept
+    {
+        const qsizetype begin = (i == 0) ? 0 : m_ends[i - 1];
+        return QByteArrayView(m_text).sliced(begin, m_ends[i] - begin);
+    }
+
+    void append(Kind kind, QByteArrayView text);
+
+    // Appends a trimmed, non-empty line, classified by its first character.
+    void appendLine(QByteArrayView line)
+    {
+        append(line.startsWith('#') ? Kind::Directive : Kind::Entry, line);
+    }
+
+    // Drops every line from `size` on.
+    void truncate(qsizetype size);
+
+    // Keeps the allocations for reuse.
+    void clear() noexcept;
+
+private:
+    QByteArray                 m_text;
+    std::vector<std::uint32_t> m_ends;      // End offset of each line in m_text
+    std::vector<Kind>          m_kinds;
+    qsizetype                  m_entryCount = 0;
+};
+
+// Turns a raw input line into trimmed, valid UTF-8. Lines that need no
+// decoding are returned as views into the input: valid UTF-8, or only ASCII
+// with InputEncoding::Windows1252. Any other line is decoded from
+// Windows-1252 (Auto), or re-encoded with its bad sequences replaced by
+// U+FFFD exactly like QStringDecoder does (Utf8).
+// Owns the scratch for that, so each thread needs its own instance.
+class LineCleaner {
+public:
+    explicit LineCleaner(InputEncoding encoding = InputEncoding::Auto) noexcept
+        : m_encoding(encoding)
+    {}
+
+    QByteArrayView clean(QByteArrayView raw);
+
+private:
+    QByteArrayView repair(QByteArrayView raw);
+    QByteArrayView fromWindows1252(QByteArrayView raw);
+
+    InputEncoding  m_encoding;
+
+    // No state is carried across lines: an incomplete sequence at the end of
+    // one line never bleeds into the next, and U+FEFF is kept as content (the
+    // file-level BOM is skipped by LineReader).
+    QStringDecoder m_decoder{QStringConverter::Utf8,
+                             QStringConverter::Flag::Stateless | QStringConverter::Flag::ConvertInitialBom};
+    QStringEncoder m_encoder{QStringConverter::Utf8};
+    QString        m_decoded;
+    QByteArray     m_repaired;
+};
+
+} // namespace LE
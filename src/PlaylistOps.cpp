@@ -0,0 +1,586 @@
+#include "PlaylistOps.h"
+#include "ConversionJob.h"
+#include "LineReader.h"
+#include "OutputWriter.h"
+#include "PathSet.h"
+#include "Playlist.h"
+#include "Logger.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LE {
+
+namespace {
+
+constexpr std::size_t kMaxFanIn      = 64;                      // Runs merged at once
+constexpr qsizetype   kMinReadBuffer = qsizetype(64) << 10;     // Per merged run
+
+int compareKeys(QByteArrayView a, QByteArrayView b) noexcept
+{
+    const qsizetype common = std::min(a.size(), b.size());
+    const int c = (common > 0) ? std::memcmp(a.data(), b.data(), static_cast<std::size_t>(common)) : 0;
+    if (c != 0) return c;
+    return (a.size() < b.size()) ? -1 : (a.size() > b.size()) ? 1 : 0;
+}
+
+// One entry with the directives in front of it. The views stay valid until
+// the next call to the source that produced it.
+struct Record {
+    QByteArrayView key;     // PathSet::appendKey() of the entry
+    QByteArrayView text;    // Directives, then the entry; each line ends in '\n'
+};
+
+class RecordSource {
+public:
+    virtual ~RecordSource() = default;
+
+    // Stores the next record in `record`. Returns false at the end.
+    virtual bool next(Record& record) = 0;
+};
+
+// ─── Sources ─────────────────────────────────────────────────────────────────
+
+// Records of a playlist file, read with the line rules of a conversion.
+class PlaylistRecords final : public RecordSource {
+public:
+    // With `checkOrder`, throws if a record sorts before the one returned
+    // before it.
+    PlaylistRecords(const QString& path, InputEncoding encoding, bool checkOrder = false)
+        : m_path(path)
+        , m_file(path)
+        , m_encoding(encoding)
+        , m_checkOrder(checkOrder)
+    {
+        m_data = Encoding::prepare(m_file.data(), m_encoding, m_transcoded);
+        m_cleaner.emplace(m_encoding);
+
+        // An #EXTM3U first line is the file's header, not a directive of the
+        // first entry.
+        LineReader reader(m_data);
+        qsizetype start = reader.position();
+        QByteArrayView raw;
+        while (reader.next(raw)) {
+            const QByteArrayView line = m_cleaner->clean(raw);
+            if (line.isEmpty()) {
+                start = reader.position();
+                continue;
+            }
+            if (line.startsWith("#EXTM3U")) {
+                m_hasHeader = true;
+                start = reader.position();
+            }
+            break;
+        }
+        m_reader.emplace(m_data.sliced(start), LineReader::Bom::Keep);
+    }
+
+    [[nodiscard]] bool hasHeader() const noexcept { return m_hasHeader; }
+
+    bool next(Record& record) override
+    {
+        std::swap(m_key, m_previousKey);    // Keeps the last key for checkOrder
+        m_text.resize(0);
+
+        QByteArrayView raw;
+        while (m_reader->next(raw)) {
+            const QByteArrayView line = m_cleaner->clean(raw);
+            if (line.isEmpty()) continue;
+
+            m_text.append(line);
+            m_text.append('\n');
+            if (line.startsWith('#')) continue;
+
+            m_key.resize(0);
+            PathSet::appendKey(line, m_key);
+            if (m_checkOrder && m_returned > 0 && compareKeys(m_key, m_previousKey) < 0) {
+                throw std::runtime_error("Playlist is not sorted: " + m_path.toStdString()
+                                         + " (line \"" + line.toByteArray().toStdString() + "\")");
+            }
+            ++m_returned;
+            record = {m_key, m_text};
+            return true;
+        }
+
+        if (!m_text.isEmpty()) {
+            qCDebug(lcConverter) << "Directives after the last entry dropped:" << m_path;
+            m_text.resize(0);
+        }
+        return false;
+    }
+
+private:
+    QString                    m_path;
+    MappedFile                 m_file;
+    QByteArray                 m_transcoded;
+    QByteArrayView             m_data;
+    InputEncoding              m_encoding;
+    std::optional<LineReader>  m_reader;
+    std::optional<LineCleaner> m_cleaner;
+    bool                       m_hasHeader  = false;
+    bool                       m_checkOrder = false;
+    qint64                     m_returned   = 0;
+    QByteArray                 m_text;
+    QByteArray                 m_key;
+    QByteArray                 m_previousKey;
+};
+
+// Sorted records spilled to a temporary file, each stored as
+// [quint32 key size][quint32 text size][key][text]. The file is deleted
+// together with the Run.
+class Run {
+public:
+    explicit Run(const QString& tempDir)
+        : m_file(QDir(tempDir).filePath("le-run-XXXXXX"))
+    {
+        if (!m_file.open()) {
+            throw std::runtime_error("Cannot create temporary file in " + tempDir.toStdString()
+                                     + " (" + m_file.errorString().toStdString() + ")");
+        }
+        m_writer.emplace(m_file);
+    }
+
+    void append(const Record& record)
+    {
+        const quint32 sizes[2] = {static_cast<quint32>(record.key.size()), static_cast<quint32>(record.text.size())};
+        m_writer->appendUtf8(QByteArrayView(reinterpret_cast<const char*>(sizes), sizeof sizes));
+        m_writer->appendUtf8(record.key);
+        m_writer->appendUtf8(record.text);
+    }
+
+    void finish()
+    {
+        m_writer->finish();
+        m_writer.reset();
+        if (!m_file.flush()) {
+            throw std::runtime_error("Cannot write temporary file: " + m_file.errorString().toStdString());
+        }
+    }
+
+    [[nodiscard]] QIODevice& device() noexcept { return m_file; }
+
+private:
+    QTemporaryFile              m_file;
+    std::optional<OutputWriter> m_writer;
+};
+
+// Reads a finished Run back through a buffer of its own.
+class RunReader final : public RecordSource {
+public:
+    RunReader(QIODevice& device, qsizetype bufferSize)
+        : m_device(device)
+        , m_capacity(bufferSize)
+    {
+        if (!m_device.seek(0)) {
+            throw std::runtime_error("Cannot read temporary file: " + m_device.errorString().toStdString());
+        }
+    }
+
+    bool next(Record& record) override
+    {
+        constexpr qsizetype kSizes = 2 * sizeof(quint32);
+        if (!fill(kSizes)) {
+            return false;
+        }
+
+        quint32 sizes[2];
+        std::memcpy(sizes, m_buffer.constData() + m_pos, kSizes);
+        const qsizetype total = kSizes + sizes[0] + sizes[1];
+        if (!fill(total)) {
+            throw std::runtime_error("Temporary file is truncated");
+        }
+
+        const QByteArrayView bytes(m_buffer.constData() + m_pos, total);
+        record.key  = bytes.sliced(kSizes, sizes[0]);
+        record.text = bytes.sliced(kSizes + sizes[0]);
+        m_pos += total;
+        return true;
+    }
+
+private:
+    // Makes `bytes` bytes available from m_pos on; false at the end of the file.
+    bool fill(qsizetype bytes)
+    {
+        if (m_buffer.size() - m_pos >= bytes) {
+            return true;
+        }
+
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+        qsizetype have = m_buffer.size();
+        m_buffer.resize(std::max(m_capacity, bytes));
+
+        while (have < m_buffer.size()) {
+            const qint64 read = m_device.read(m_buffer.data() + have, m_buffer.size() - have);
+            if (read < 0) {
+                throw std::runtime_error("Cannot read temporary file: " + m_device.errorString().toStdString());
+            }
+            if (read == 0) break;
+            have += read;
+        }
+        m_buffer.resize(have);
+        return have >= bytes;
+    }
+
+    QIODevice& m_device;
+    qsizetype  m_capacity;
+    QByteArray m_buffer;
+    qsizetype  m_pos = 0;
+};
+
+// ─── Merge ───────────────────────────────────────────────────────────────────
+
+// k-way merge of sorted sources. Records with equal keys come in source
+// order, which keeps the merge stable. `emit` is done with a record before
+// its source moves on.
+template <typename Emit>
+void mergeSources(const std::vector<RecordSource*>& sources, Emit&& emit)
+{
+    struct Head {
+        Record      record;
+        std::size_t source;
+    };
+    const auto later = [](const Head& a, const Head& b) {
+        const int c = compareKeys(a.record.key, b.record.key);
+        return (c != 0) ? c > 0 : a.source > b.source;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heap(later);
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        Record record;
+        if (sources[i]->next(record)) {
+            heap.push({record, i});
+        }
+    }
+
+    while (!heap.empty()) {
+        const Head head = heap.top();
+        heap.pop();
+        emit(head.record);
+
+        Record record;
+        if (sources[head.source]->next(record)) {
+            heap.push({record, head.source});
+        }
+    }
+}
+
+// Output playlist, replaced atomically by commit().
+class PlaylistSink {
+public:
+    PlaylistSink(const QString& path, bool header)
+        : m_file(path)
+    {
+        openOutput(m_file);
+        m_writer.emplace(m_file);
+        if (header) {
+            m_writer->appendUtf8("#EXTM3U");
+            m_writer->endLine();
+        }
+    }
+
+    // Writes a record's lines with the platform's line endings.
+    void append(QByteArrayView text)
+    {
+        LineReader lines(text, LineReader::Bom::Keep);
+        QByteArrayView line;
+        while (lines.next(line)) {
+            m_writer->appendUtf8(line);
+            m_writer->endLine();
+        }
+    }
+
+    void commit()
+    {
+        m_writer->finish();
+        commitOutput(m_file);
+    }
+
+private:
+    QSaveFile                   m_file;
+    std::optional<OutputWriter> m_writer;
+};
+
+// Drops records whose key equals the previous one (SortOptions::dedup) and
+// counts what passes through.
+class Deduplicated {
+public:
+    Deduplicated(bool enabled, SortStats& stats)
+        : m_enabled(enabled)
+        , m_stats(stats)
+    {}
+
+    // False if `record` repeats the previous key.
+    bool accept(const Record& record)
+    {
+        if (m_enabled) {
+            if (m_any && compareKeys(record.key, m_last) == 0) {
+                ++m_stats.duplicates;
+                return false;
+            }
+            m_last.resize(0);
+            m_last.append(record.key);
+            m_any = true;
+        }
+        return true;
+    }
+
+private:
+    bool       m_enabled;
+    SortStats& m_stats;
+    bool       m_any = false;
+    QByteArray m_last;
+};
+
+// ─── Sorting ─────────────────────────────────────────────────────────────────
+
+// Collects records in memory up to the budget and spills them as sorted runs.
+class RunBuilder {
+public:
+    explicit RunBuilder(const SortOptions& options)
+        : m_options(options)
+        , m_tempDir(options.tempDir.isEmpty() ? QDir::tempPath() : options.tempDir)
+    {}
+
+    void add(const Record& record)
+    {
+        m_slots.push_back({m_arena.size(), record.key.size(), record.text.size()});
+        m_arena.append(record.key);
+        m_arena.append(record.text);
+
+        if (m_arena.size() + static_cast<qint64>(m_slots.size() * sizeof(Slot)) >= m_options.memoryBudget) {
+            spill();
+        }
+    }
+
+    // Writes every record added, in order.
+    void writeTo(PlaylistSink& out, SortStats& stats)
+    {
+        Deduplicated dedup(m_options.dedup, stats);
+        const auto write = [&](const Record& record) {
+            if (dedup.accept(record)) {
+                out.append(record.text);
+                ++stats.records;
+            }
+        };
+
+        if (m_runs.empty()) {
+            sortSlots();
+            for (const Slot& slot : m_slots) {
+                write(recordAt(slot));
+            }
+            return;
+        }
+
+        if (!m_slots.empty()) {
+            spill();
+        }
+        stats.runs = static_cast<qint64>(m_runs.size());
+
+        // Too many runs to hold open at once: merge them group by group,
+        // in order, until few enough are left.
+        while (m_runs.size() > kMaxFanIn) {
+            std::vector<std::unique_ptr<Run>> merged;
+            for (std::size_t first = 0; first < m_runs.size(); first += kMaxFanIn) {
+                const std::size_t last = std::min(first + kMaxFanIn, m_runs.size());
+                auto run = std::make_unique<Run>(m_tempDir);
+                mergeRuns(first, last, [&](const Record& record) { run->append(record); });
+                run->finish();
+                merged.push_back(std::move(run));
+            }
+            m_runs = std::move(merged);
+        }
+        mergeRuns(0, m_runs.size(), write);
+    }
+
+    // Dropped while spilling; writeTo() counts the rest.
+    [[nodiscard]] qint64 spilledDuplicates() const noexcept { return m_spilledDuplicates; }
+
+private:
+    struct Slot {
+        qsizetype offset;
+        qsizetype keySize;
+        qsizetype textSize;
+    };
+
+    [[nodiscard]] Record recordAt(const Slot& slot) const
+    {
+        const QByteArrayView bytes = QByteArrayView(m_arena).sliced(slot.offset, slot.keySize + slot.textSize);
+        return {bytes.first(slot.keySize), bytes.sliced(slot.keySize)};
+    }
+
+    void sortSlots()
+    {
+        std::stable_sort(m_slots.begin(), m_slots.end(), [this](const Slot& a, const Slot& b) {
+            return compareKeys(recordAt(a).key, recordAt(b).key) < 0;
+        });
+    }
+
+    // Later duplicates within a run are dropped right away; they would lose
+    // to the first one in the merge anyway.
+    void spill()
+    {
+        sortSlots();
+
+        auto run = std::make_unique<Run>(m_tempDir);
+        QByteArrayView previous;
+        bool any = false;
+        for (const Slot& slot : m_slots) {
+            const Record record = recordAt(slot);
+            if (m_options.dedup && any && compareKeys(record.key, previous) == 0) {
+                ++m_spilledDuplicates;
+                continue;
+            }
+            run->append(record);
+            previous = record.key;
+            any = true;
+        }
+        run->finish();
+        m_runs.push_back(std::move(run));
+
+        qCDebug(lcConverter) << "Spilled run" << m_runs.size() << "with" << m_slots.size() << "records";
+        m_slots.clear();
+        m_arena.resize(0);
+    }
+
+    template <typename Emit>
+    void mergeRuns(std::size_t first, std::size_t last, Emit&& emit)
+    {
+        const qsizetype bufferSize = std::max<qsizetype>(
+            kMinReadBuffer, static_cast<qsizetype>(m_options.memoryBudget / static_cast<qint64>(last - first)));
+
+        std::vector<std::unique_ptr<RunReader>> readers;
+        std::vector<RecordSource*> sources;
+        for (std::size_t i = first; i < last; ++i) {
+            readers.push_back(std::make_unique<RunReader>(m_runs[i]->device(), bufferSize));
+            sources.push_back(readers.back().get());
+        }
+        mergeSources(sources, emit);
+    }
+
+    const SortOptions&                m_options;
+    QString                           m_tempDir;
+    QByteArray                        m_arena;
+    std::vector<Slot>                 m_slots;
+    std::vector<std::unique_ptr<Run>> m_runs;
+    qint64                            m_spilledDuplicates = 0;
+};
+
+void logStats(const char* operation, const QString& output, const SortStats& stats)
+{
+    qCInfo(lcConverter) << operation << stats.records << "records into" << output << "("
+                        << stats.duplicates << "duplicates dropped," << stats.runs << "runs spilled)";
+}
+
+} // namespace
+
+namespace PlaylistOps {
+
+SortStats sort(const QString& input, const QString& output, const SortOptions& options)
+{
+    return merge(QStringList{input}, output, options);
+}
+
+SortStats merge(const QStringList& inputs, const QString& output, const SortOptions& options)
+{
+    SortStats stats;
+    bool header = false;
+
+    if (options.presorted) {
+        std::vector<std::unique_ptr<PlaylistRecords>> inputRecords;
+        std::vector<RecordSource*> sources;
+        for (const QString& input : inputs) {
+            inputRecords.push_back(std::make_unique<PlaylistRecords>(input, options.inputEncoding, true));
+            sources.push_back(inputRecords.back().get());
+            header = header || inputRecords.back()->hasHeader();
+        }
+
+        PlaylistSink out(output, header);
+        Deduplicated dedup(options.dedup, stats);
+        mergeSources(sources, [&](const Record& record) {
+            if (dedup.accept(record)) {
+                out.append(record.text);
+                ++stats.records;
+            }
+        });
+        out.commit();
+        logStats("Merged", output, stats);
+        return stats;
+    }
+
+    // Every input is read into runs first and released before the output
+    // is written, so an output may replace one of the inputs.
+    RunBuilder runs(options);
+    for (const QString& input : inputs) {
+        PlaylistRecords records(input, options.inputEncoding);
+        header = header || records.hasHeader();
+
+        Record record;
+        while (records.next(record)) {
+            runs.add(record);
+        }
+    }
+
+    PlaylistSink out(output, header);
+    runs.writeTo(out, stats);
+    stats.duplicates += runs.spilledDuplicates();
+    out.commit();
+
+    logStats(inputs.size() == 1 ? "Sorted" : "Merged", output, stats);
+    return stats;
+}
+
+QStringList split(const QString& input, qint64 recordsPerPart, const QString& outputDir, InputEncoding encoding)
+{
+    if (recordsPerPart < 1) {
+        throw std::runtime_error("A part must hold at least one entry.");
+    }
+
+    PlaylistRecords records(input, encoding);
+    const QFileInfo info(input);
+    const QDir dir(outputDir.isEmpty() ? info.absolutePath() : outputDir);
+
+    QStringList parts;
+    std::optional<PlaylistSink> out;
+    qint64 inPart = 0;
+
+    Record record;
+    while (records.next(record)) {
+        if (!out) {
+            const QString path = dir.filePath(QString("%1.part%2.%3")
+                                                  .arg(info.completeBaseName())
+                                                  .arg(parts.size() + 1, 3, 10, QChar('0'))
+                                                  .arg(info.suffix()));
+            out.emplace(path, records.hasHeader());
+            parts << path;
+        }
+
+        out->append(record.text);
+        if (++inPart == recordsPerPart) {
+            out->commit();
+            out.reset();
+            inPart = 0;
+        }
+    }
+    if (out) {
+        out->commit();
+    }
+
+    qCInfo(lcConverter) << "Split" << input << "into" << parts.size() << "parts";
+    return parts;
+}
+
+} // namespace PlaylistOps
+
+} // namespace LE
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Encoding.h"
+
+#include <QString>
+#include <QStringList>
+
+namespace LE {
+
+// Sort, merge and split of playlists of any size.
+//
+// The unit moved around is a record: one entry together with the directives
+// in front of it, so #EXTINF lines stay with their track. The #EXTM3U header
+// is not part of any record; an output gets one if an input had one.
+// Directives after the last entry belong to no record and are dropped.
+// Lines are read like a conversion reads them (encoding, trimming, blank
+// lines) and written out unchanged otherwise, as UTF-8.
+//
+// Sorting orders records by entry path in Windows semantics: the
+// Converter::normalizePath form, ignoring case (PathSet::appendKey). Equal
+// paths keep their input order. Up to SortOptions::memoryBudget bytes of
+// records are sorted in memory; beyond that, sorted runs are spilled to
+// temporary files and combined by a k-way merge.
+//
+// Throws std::runtime_error on any I/O failure; outputs are replaced
+// atomically, so a failed operation leaves them untouched.
+struct SortOptions {
+    // Records held in memory before a sorted run is spilled, and the read
+    // buffers of the final merge.
+    qint64 memoryBudget = qint64(256) << 20;
+
+    // Folder for spilled runs; the system temporary folder if empty.
+    QString tempDir;
+
+    // Keep only the first record of every path.
+    bool dedup = false;
+
+    // merge(): every input is sorted already and is streamed into the merge
+    // as is, without building runs. An input found out of order throws.
+    bool presorted = false;
+
+    InputEncoding inputEncoding = InputEncoding::Auto;
+};
+
+struct SortStats {
+    qint64 records    = 0;      // Written
+    qint64 duplicates = 0;      // Dropped by SortOptions::dedup
+    qint64 runs       = 0;      // Spilled to disk; 0 if everything fit in memory
+};
+
+namespace PlaylistOps {
+
+// Writes the records of `input` to `output`, sorted by path.
+SortStats sort(const QString& input, const QString& output, const SortOptions& options = {});
+
+// Writes the records of all `inputs` to `output` as one list sorted by
+// path. Records with equal paths come in the order of `inputs`.
+SortStats merge(const QStringList& inputs, const QString& output, const SortOptions& options = {});
+
+// Cuts `input` into parts of `recordsPerPart` records each, in order, named
+// <name>.part001.<ext>, <name>.part002.<ext>… in `outputDir` (the folder of
+// the input if empty). Memory use does not depend on the input size.
+// Returns the paths written.
+QStringList split(const QString& input, qint64 recordsPerPart, const QString& outputDir = {},
+                  InputEncoding encoding = InputEncoding::Auto);
+
+} // namespace PlaylistOps
+
+} // namespace LE
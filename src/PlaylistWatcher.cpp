@@ -0,0 +1,109 @@
+#include "PlaylistWatcher.h"
+#include "Logger.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace LE {
+
+PlaylistWatcher::PlaylistWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_settle.setSingleShot(true);
+    m_settle.setInterval(kSettleMs);
+
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &PlaylistWatcher::onFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &PlaylistWatcher::onDirectoryChanged);
+    connect(&m_settle, &QTimer::timeout, this, &PlaylistWatcher::reconvertPending);
+}
+
+PlaylistWatcher::~PlaylistWatcher() = default;
+
+void PlaylistWatcher::watch(std::unique_ptr<IncrementalConverter> converter)
+{
+    const QFileInfo info(converter->params().inputPath);
+    const QString path = info.absoluteFilePath();
+    const QString directory = info.absolutePath();
+
+    if (m_watcher.addPath(path)) {
+        m_watchedFiles.insert(path);
+    } else {
+        qCWarning(lcConverter) << "Cannot watch" << path;
+    }
+    if (!m_byDirectory.contains(directory)) {
+        m_watcher.addPath(directory);
+    }
+    m_byDirectory.insert(directory, path);
+    m_playlists[path] = std::move(converter);
+}
+
+// A file that was replaced rather than rewritten may have dropped out of
+// the watch, which QFileSystemWatcher does not tell apart; watching it
+// again keeps m_watchedFiles exact.
+void PlaylistWatcher::onFileChanged(const QString& path)
+{
+    rewatch(path);
+    schedule(path);
+}
+
+// Our own output files land in watched folders too; only playlists that
+// fell out of the file watch are of interest here.
+void PlaylistWatcher::onDirectoryChanged(const QString& directory)
+{
+    for (const QString& path : m_byDirectory.values(directory)) {
+        if (!m_watchedFiles.contains(path)) {
+            schedule(path);
+        }
+    }
+}
+
+void PlaylistWatcher::rewatch(const QString& path)
+{
+    if (m_watchedFiles.remove(path)) {
+        m_watcher.removePath(path);
+    }
+    if (QFileInfo::exists(path) && m_watcher.addPath(path)) {
+        m_watchedFiles.insert(path);
+    }
+}
+
+// Every new notification restarts the settle timer.
+void PlaylistWatcher::schedule(const QString& path)
+{
+    m_pending.insert(path);
+    m_settle.start();
+}
+
+void PlaylistWatcher::reconvertPending()
+{
+    QStringList pending(m_pending.cbegin(), m_pending.cend());
+    m_pending.clear();
+    std::sort(pending.begin(), pending.end());
+
+    for (const QString& path : pending) {
+        // Deleted, or not yet renamed into place; the folder watch reports it
+        // again when it reappears.
+        if (!QFileInfo::exists(path)) {
+            qCDebug(lcConverter) << "Watched playlist is gone:" << path;
+            continue;
+        }
+        if (!m_watchedFiles.contains(path)) {
+            rewatch(path);
+        }
+
+        IncrementalConverter& converter = *m_playlists.at(path);
+        try {
+            const auto result = converter.update();
+            if (result.written) {
+                emit reconverted(path, converter.params().outputPath, result.blocksConverted, result.blocks);
+            }
+        } catch (const std::exception& e) {
+            emit failed(path, QString::fromStdString(e.what()));
+        }
+    }
+}
+
+} // namespace LE
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "IncrementalConverter.h"
+
+#include <QFileSystemWatcher>
+#include <QMultiHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include <map>
+#include <memory>
+
+namespace LE {
+
+// Watch mode: reconverts playlists whenever they change on disk.
+//
+// Notifications are collected until the files have been quiet for kSettleMs
+// (media servers write a playlist in several steps), then each changed
+// playlist is brought up to date by its IncrementalConverter, on the
+// watcher's thread. A playlist that is replaced rather than rewritten drops
+// out of QFileSystemWatcher, so its folder is watched as well and the new
+// file is picked up from there.
+class PlaylistWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int kSettleMs = 500;
+
+    explicit PlaylistWatcher(QObject* parent = nullptr);
+    ~PlaylistWatcher() override;
+
+    // Starts watching the input of `converter`, which is expected to have
+    // converted it once already.
+    void watch(std::unique_ptr<IncrementalConverter> converter);
+
+    [[nodiscard]] qsizetype size() const noexcept { return static_cast<qsizetype>(m_playlists.size()); }
+
+signals:
+    // Emitted after an output was rewritten; not for changes that left it as it was.
+    void reconverted(const QString& inputPath, const QString& outputPath, qint64 blocksConverted, qint64 blocks);
+    void failed(const QString& inputPath, const QString& error);
+
+private:
+    void onFileChanged(const QString& path);
+    void onDirectoryChanged(const QString& directory);
+    void schedule(const QString& path);
+
+    // Watches `path` as the file now on disk, if there is one.
+    void rewatch(const QString& path);
+    void reconvertPending();
+
+    QFileSystemWatcher m_watcher;
+    QTimer             m_settle;
+
+    std::map<QString, std::unique_ptr<IncrementalConverter>> m_playlists;   // By absolute input path
+    QMultiHash<QString, QString> m_byDirectory;                             // Folder → input paths
+    QSet<QString>                m_pending;
+    QSet<QString>                m_watchedFiles;    // Input paths with a file watch of their own
+};
+
+} // namespace LE
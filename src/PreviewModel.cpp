@@ -0,0 +1,221 @@
+#include "PreviewModel.h"
+#include "OutputWriter.h"
+#include "Playlist.h"
+#include "Logger.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+
+#include <exception>
+#include <utility>
+
+namespace LE {
+
+PreviewModel::PreviewModel(QObject* parent)
+    : QAbstractListModel(parent)
+{}
+
+PreviewModel::~PreviewModel() = default;
+
+void PreviewModel::setInput(const ConversionParams& params)
+{
+    // Map first: a file that cannot be read leaves the model as it was.
+    std::unique_ptr<MappedFile> input;
+    if (!params.inputPath.isEmpty()) {
+        input = std::make_unique<MappedFile>(params.inputPath);
+    }
+
+    beginResetModel();
+
+    m_rows.clear();
+    m_lineStarts.clear();
+    m_pipeline.reset();
+    m_job.reset();
+    m_transcoded.clear();
+    m_data     = {};
+    m_scanned  = 0;
+    m_encoding = params.inputEncoding;
+    m_input    = std::move(input);
+
+    if (m_input) {
+        m_data = Encoding::prepare(m_input->data(), m_encoding, m_transcoded);
+        if (m_data.startsWith("\xEF\xBB\xBF")) {
+            m_scanned = 3;
+        }
+        qCDebug(lcConverter) << "Preview of" << params.inputPath << "(" << m_data.size() << "bytes)";
+    }
+    setParams(params);
+
+    endResetModel();
+}
+
+void PreviewModel::setParams(const ConversionParams& params)
+{
+    m_rows.clear();
+    m_pipeline.reset();
+    m_job.reset();
+    m_error.clear();
+
+    if (m_input) {
+        // The preview must not touch the disk for every row it shows.
+        ConversionParams preview = params;
+        preview.inputEncoding = m_encoding;
+        preview.validation    = ValidationMode::Off;
+        preview.libraryIndex.clear();
+
+        try {
+            m_job = std::make_unique<ConversionJob>(preview);
+            (void)m_job->prepareInput(m_data);
+            m_pipeline.emplace(m_job->pipeline());
+        } catch (const std::exception& e) {
+            m_job.reset();
+            m_error = QString::fromStdString(e.what());
+        }
+    }
+
+    if (!m_lineStarts.empty()) {
+        emit dataChanged(index(0), index(rowCount() - 1), {ConvertedRole, Qt::ToolTipRole});
+    }
+}
+
+int PreviewModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_lineStarts.size());
+}
+
+QVariant PreviewModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return {};
+    }
+
+    switch (role) {
+        case Qt::DisplayRole:
+            return row(index.row()).original;
+        case ConvertedRole:
+            return row(index.row()).converted;
+        case Qt::ToolTipRole: {
+            const Row& r = row(index.row());
+            return r.original + u'\n' + (m_job ? QStringLiteral(u"→ ") + r.converted : m_error);
+        }
+        default:
+            return {};
+    }
+}
+
+bool PreviewModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_scanned < m_data.size();
+}
+
+// Uses the filter's line rules, so the rows are exactly the entries a
+// conversion would transform.
+void PreviewModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    LineReader  reader(m_data.sliced(m_scanned), LineReader::Bom::Keep);
+    LineCleaner cleaner(m_encoding);
+    std::vector<qsizetype> found;
+    found.reserve(kFetchLines);
+
+    QByteArrayView raw;
+    while (found.size() < static_cast<std::size_t>(kFetchLines)) {
+        const qsizetype start = reader.position();
+        if (!reader.next(raw)) break;
+
+        const QByteArrayView line = cleaner.clean(raw);
+        if (!line.isEmpty() && !line.startsWith('#')) {
+            found.push_back(m_scanned + start);
+        }
+    }
+    m_scanned += reader.position();
+
+    if (found.empty()) {
+        return;
+    }
+
+    const int first = rowCount();
+    beginInsertRows({}, first, first + static_cast<int>(found.size()) - 1);
+    m_lineStarts.insert(m_lineStarts.end(), found.begin(), found.end());
+    endInsertRows();
+}
+
+// The reference is valid until the next call.
+const PreviewModel::Row& PreviewModel::row(int index) const
+{
+    if (const Row* cached = m_rows.object(index)) {
+        return *cached;
+    }
+
+    LineReader reader(m_data.sliced(m_lineStarts[static_cast<std::size_t>(index)]), LineReader::Bom::Keep);
+    QByteArrayView raw;
+    reader.next(raw);
+
+    LineCleaner cleaner(m_encoding);
+    auto entry = std::make_unique<Row>();
+    entry->original = QString::fromUtf8(cleaner.clean(raw));
+
+    if (m_pipeline) {
+        MemorySink      out;
+        ConversionHooks hooks;
+        JobMonitor      monitor(hooks, raw.size());
+        m_pipeline->runChunk(raw, out, monitor);
+
+        QByteArrayView converted = out.bytes();
+        while (converted.endsWith('\n') || converted.endsWith('\r')) {
+            converted.chop(1);
+        }
+        entry->converted = QString::fromUtf8(converted);
+    }
+
+    Row* const result = entry.release();
+    m_rows.insert(index, result);
+    return *result;
+}
+
+// ─── PreviewDelegate ─────────────────────────────────────────────────────────
+
+void PreviewDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+
+    // Background, selection and focus frame; the text is drawn below.
+    const QString original = opt.text;
+    opt.text.clear();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    const QString converted = index.data(PreviewModel::ConvertedRole).toString();
+    const QString arrow = QStringLiteral(u"→");
+
+    const QRect area = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+    const int arrowWidth = opt.fontMetrics.horizontalAdvance(arrow) + 16;
+    const int half = (area.width() - arrowWidth) / 2;
+
+    const QRect left(area.left(), area.top(), half, area.height());
+    const QRect middle(left.right() + 1, area.top(), arrowWidth, area.height());
+    const QRect right(middle.right() + 1, area.top(), area.right() - middle.right(), area.height());
+
+    const QPalette::ColorGroup group = (opt.state & QStyle::State_Enabled) ? QPalette::Normal : QPalette::Disabled;
+    const QPalette::ColorRole text = (opt.state & QStyle::State_Selected) ? QPalette::HighlightedText : QPalette::Text;
+
+    painter->save();
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(group, text));
+    painter->drawText(left, Qt::AlignLeft | Qt::AlignVCenter,
+                      opt.fontMetrics.elidedText(original, Qt::ElideMiddle, left.width()));
+    painter->drawText(right, Qt::AlignLeft | Qt::AlignVCenter,
+                      opt.fontMetrics.elidedText(converted, Qt::ElideMiddle, right.width()));
+    painter->setPen(opt.palette.color(group, QPalette::PlaceholderText));
+    painter->drawText(middle, Qt::AlignCenter, arrow);
+    painter->restore();
+}
+
+} // namespace LE
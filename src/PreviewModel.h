@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ConversionJob.h"
+#include "Converter.h"
+#include "LineReader.h"
+#include "Pipeline.h"
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCache>
+#include <QString>
+#include <QStyledItemDelegate>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace LE {
+
+// Before/after view of the entries of a playlist, for huge inputs.
+//
+// The input is memory-mapped and indexed lazily: fetchMore() records the
+// offsets of the next batch of entry lines as the view scrolls towards the
+// end, so opening a file costs nothing up front. Rows are converted when a
+// view asks for them, through the same pipeline as a real conversion, and
+// kept in a small cache; nothing else of the file is ever transformed.
+// Directives and blank lines are not listed. Validation is never run.
+class PreviewModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        ConvertedRole = Qt::UserRole + 1     // QString; Qt::DisplayRole is the original
+    };
+
+    static constexpr int kFetchLines = 16384;
+    static constexpr int kCachedRows = 4096;
+
+    explicit PreviewModel(QObject* parent = nullptr);
+    ~PreviewModel() override;
+
+    // Maps and starts indexing `params.inputPath`; an empty path clears the
+    // model. Throws std::runtime_error if the file cannot be read.
+    void setInput(const ConversionParams& params);
+
+    // Re-converts the rows with new settings (base path, location mode…),
+    // keeping the index and the view's scroll position. Settings that do
+    // not convert, such as a missing base path, leave the converted side
+    // empty; conversionError() tells why.
+    void setParams(const ConversionParams& params);
+
+    [[nodiscard]] const QString& conversionError() const noexcept { return m_error; }
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    struct Row {
+        QString original;
+        QString converted;
+    };
+
+    const Row& row(int index) const;
+
+    std::unique_ptr<MappedFile>    m_input;
+    QByteArray                     m_transcoded;    // UTF-16 input only
+    QByteArrayView                 m_data;
+    InputEncoding                  m_encoding = InputEncoding::Auto;
+
+    std::vector<qsizetype>         m_lineStarts;    // Entry lines indexed so far
+    qsizetype                      m_scanned = 0;   // Bytes of m_data indexed
+
+    std::unique_ptr<ConversionJob> m_job;
+    std::optional<Pipeline>        m_pipeline;      // Refers to m_job
+    QString                        m_error;
+
+    mutable QCache<int, Row>       m_rows{kCachedRows};
+};
+
+// Paints a PreviewModel row as two columns, original and converted, each
+// elided in the middle so that both ends of a long path stay visible.
+class PreviewDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+};
+
+} // namespace LE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace LE {
+
+// Bounded single-producer / single-consumer queue.
+// push() and pop() are lock-free; they only block (via C++20 atomic wait)
+// when the queue is full or empty. close() ends the stream: the producer's
+// next push() fails, and the consumer's pop() fails once the queue is drained.
+//
+// Meant for moving whole batches between pipeline stages, so Capacity is small.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Blocks while the queue is full. Returns false if the queue is closed.
+    bool push(T&& value)
+    {
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::uint32_t signal = m_signal.load(std::memory_order_acquire);
+            if (m_closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (head - m_tail.load(std::memory_order_acquire) < Capacity) {
+                break;
+            }
+            m_signal.wait(signal, std::memory_order_acquire);
+        }
+
+        m_slots[head & kMask] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Blocks while the queue is empty. Returns false once the queue is closed
+    // and every pushed element has been consumed.
+    bool pop(T& value)
+    {
+        const std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::uint32_t signal = m_signal.load(std::memory_order_acquire);
+            if (m_head.load(std::memory_order_acquire) != tail) {
+                break;
+            }
+            if (m_closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            m_signal.wait(signal, std::memory_order_acquire);
+        }
+
+        value = std::move(m_slots[tail & kMask]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Non-blocking push. Returns false, leaving `value` untouched, if the
+    // queue is full or closed.
+    bool tryPush(T&& value)
+    {
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (m_closed.load(std::memory_order_acquire) ||
+            head - m_tail.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+
+        m_slots[head & kMask] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Non-blocking pop. Returns false if the queue is currently empty.
+    bool tryPop(T& value)
+    {
+        const std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_head.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+
+        value = std::move(m_slots[tail & kMask]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Safe to call from either side, any number of times.
+    void close()
+    {
+        m_closed.store(true, std::memory_order_release);
+        wake();
+    }
+
+private:
+    static constexpr std::uint64_t kMask = Capacity - 1;
+
+    // Every state change bumps m_signal, so a waiter that sampled it before
+    // checking the queue can never miss the wake-up.
+    void wake()
+    {
+        m_signal.fetch_add(1, std::memory_order_acq_rel);
+        m_signal.notify_all();
+    }
+
+    std::array<T, Capacity> m_slots{};
+
+    alignas(64) std::atomic<std::uint64_t> m_head{0};
+    alignas(64) std::atomic<std::uint64_t> m_tail{0};
+    alignas(64) std::atomic<std::uint32_t> m_signal{0};
+    std::atomic<bool>                      m_closed{false};
+};
+
+} // namespace LE
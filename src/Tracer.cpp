@@ -0,0 +1,226 @@
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LE {
+
+namespace {
+
+struct Event {
+    const char* name;
+    qint64      startNs;
+    qint64      endNs;
+    QString     detail;
+};
+
+// The mutex is only ever contended while the trace is being written.
+struct ThreadBuffer {
+    std::mutex         mutex;
+    std::vector<Event> events;
+    QString            name;
+    qint64             tid = 0;
+};
+
+struct Session {
+    std::atomic<bool> enabled{false};
+    std::atomic<int>  generation{0};
+
+    std::mutex mutex;       // Guards everything below
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    qint64 originNs = 0;
+    qint64 nextTid  = 0;
+};
+
+Session& session()
+{
+    static Session instance;
+    return instance;
+}
+
+// A thread's buffer belongs to one session; the thread registers a new one
+// when it first records in the next session.
+struct ThreadSlot {
+    int generation = -1;
+    std::shared_ptr<ThreadBuffer> buffer;
+};
+
+thread_local ThreadSlot t_slot;
+
+QString defaultThreadName()
+{
+    QThread* const thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        return "main";
+    }
+    return thread->objectName();
+}
+
+ThreadBuffer& threadBuffer()
+{
+    Session& s = session();
+    if (t_slot.buffer && t_slot.generation == s.generation.load(std::memory_order_acquire)) {
+        return *t_slot.buffer;
+    }
+
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->name = defaultThreadName();
+
+    const std::lock_guard lock(s.mutex);
+    buffer->tid = ++s.nextTid;
+    if (buffer->name.isEmpty()) {
+        buffer->name = QString("thread %1").arg(buffer->tid);
+    }
+    s.buffers.push_back(buffer);
+    t_slot = {s.generation.load(std::memory_order_relaxed), std::move(buffer)};
+    return *t_slot.buffer;
+}
+
+QJsonObject toJson(const ThreadBuffer& buffer, const Event& event, qint64 originNs, qint64 pid)
+{
+    QJsonObject json{
+        {"name", QString::fromLatin1(event.name)},
+        {"cat",  "le"},
+        {"ph",   "X"},
+        {"ts",   static_cast<double>(event.startNs - originNs) / 1e3},
+        {"dur",  static_cast<double>(event.endNs - event.startNs) / 1e3},
+        {"pid",  pid},
+        {"tid",  buffer.tid},
+    };
+    if (!event.detail.isEmpty()) {
+        json.insert("args", QJsonObject{{"detail", event.detail}});
+    }
+    return json;
+}
+
+} // namespace
+
+namespace Tracer {
+
+void start()
+{
+    Session& s = session();
+    const std::lock_guard lock(s.mutex);
+    s.buffers.clear();
+    s.originNs = now();
+    s.generation.fetch_add(1, std::memory_order_release);
+    s.enabled.store(true, std::memory_order_release);
+    qCInfo(lcPerf) << "Tracing started";
+}
+
+void stop(const QString& path)
+{
+    Session& s = session();
+    s.enabled.store(false, std::memory_order_release);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    qint64 originNs = 0;
+    {
+        const std::lock_guard lock(s.mutex);
+        buffers.swap(s.buffers);
+        originNs = s.originNs;
+        s.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    qsizetype spans = 0;
+
+    for (const auto& buffer : buffers) {
+        const std::lock_guard lock(buffer->mutex);
+        events.append(QJsonObject{
+            {"name", "thread_name"},
+            {"ph",   "M"},
+            {"pid",  pid},
+            {"tid",  buffer->tid},
+            {"args", QJsonObject{{"name", buffer->name}}},
+        });
+        for (const Event& event : buffer->events) {
+            events.append(toJson(*buffer, event, originNs, pid));
+        }
+        spans += static_cast<qsizetype>(buffer->events.size());
+    }
+
+    const QJsonObject trace{
+        {"traceEvents",     events},
+        {"displayTimeUnit", "ms"},
+    };
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) < 0 ||
+        !file.commit())
+    {
+        throw std::runtime_error("Cannot write trace file: " + path.toStdString()
+                                 + " (" + file.errorString().toStdString() + ")");
+    }
+
+    qCInfo(lcPerf) << "Trace written:" << path << spans << "spans on" << buffers.size() << "threads";
+}
+
+bool isEnabled() noexcept
+{
+    return session().enabled.load(std::memory_order_relaxed);
+}
+
+qint64 now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char* name, qint64 startNs, qint64 endNs, const QString& detail)
+{
+    if (!isEnabled()) return;
+
+    ThreadBuffer& buffer = threadBuffer();
+    const std::lock_guard lock(buffer.mutex);
+    buffer.events.push_back({name, startNs, endNs, detail});
+}
+
+void setThreadName(const QString& name)
+{
+    if (!isEnabled()) return;
+
+    ThreadBuffer& buffer = threadBuffer();
+    const std::lock_guard lock(buffer.mutex);
+    buffer.name = name;
+}
+
+} // namespace Tracer
+
+// ─── TraceSession ────────────────────────────────────────────────────────────
+
+TraceSession::TraceSession(QString path)
+    : m_path(std::move(path))
+{
+    if (!m_path.isEmpty()) {
+        Tracer::start();
+    }
+}
+
+TraceSession::~TraceSession()
+{
+    if (m_path.isEmpty()) return;
+
+    try {
+        Tracer::stop(m_path);
+    } catch (const std::exception& e) {
+        qCWarning(lcPerf) << e.what();
+    }
+}
+
+} // namespace LE
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QString>
+
+namespace LE {
+
+// Opt-in recorder of timed spans, written as Chrome trace-event JSON for
+// Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+// Each thread records into a buffer of its own, registered the first time
+// it records in a session, so tracing never makes the workers wait on each
+// other. While no session runs, every call returns after one relaxed load.
+namespace Tracer {
+
+// Starts a session, discarding spans of an earlier one.
+void start();
+
+// Ends the session and writes its spans to `path`. Throws
+// std::runtime_error if the file cannot be written.
+void stop(const QString& path);
+
+[[nodiscard]] bool isEnabled() noexcept;
+
+// Monotonic time of the trace clock, in nanoseconds.
+[[nodiscard]] qint64 now() noexcept;
+
+// Records a span from `startNs` to `endNs` on the calling thread. `name`
+// must outlive the session (a string literal); `detail` is shown as its
+// argument, e.g. the file a span worked on.
+void record(const char* name, qint64 startNs, qint64 endNs, const QString& detail = {});
+
+// Names the calling thread in the trace. Threads left unnamed show their
+// QThread object name.
+void setThreadName(const QString& name);
+
+} // namespace Tracer
+
+// Records the time until it goes out of scope as a span of `name`.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const QString& detail = {})
+        : m_name(name)
+        , m_start(Tracer::isEnabled() ? Tracer::now() : -1)
+    {
+        if (m_start >= 0) m_detail = detail;
+    }
+
+    ~TraceSpan()
+    {
+        if (m_start >= 0) Tracer::record(m_name, m_start, Tracer::now(), m_detail);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    qint64      m_start;
+    QString     m_detail;
+};
+
+// Traces the lifetime of the object to `path`; does nothing if `path` is
+// empty. Failures to write the trace are logged, not thrown.
+class TraceSession {
+public:
+    explicit TraceSession(QString path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    QString m_path;
+};
+
+} // namespace LE
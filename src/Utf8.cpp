@@ -0,0 +1,195 @@
+#include "Utf8.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU, so no runtime dispatch is needed.
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LE_UTF8_SSE2 1
+#  include <emmintrin.h>
+#else
+#  define LE_UTF8_SSE2 0
+#endif
+
+namespace LE::Utf8 {
+
+namespace {
+
+constexpr std::uint64_t kHighBits = 0x8080808080808080ull;
+
+using Byte = unsigned char;
+
+// Three-byte encodings of the non-Latin-1 space separators:
+// U+1680, U+2000–U+200A, U+2028, U+2029, U+202F, U+205F and U+3000.
+bool isSpace3(const Byte* p) noexcept
+{
+    switch (p[0]) {
+        case 0xE1: return p[1] == 0x9A && p[2] == 0x80;
+        case 0xE2:
+            if (p[1] == 0x80) {
+                return (p[2] >= 0x80 && p[2] <= 0x8A) || p[2] == 0xA8 || p[2] == 0xA9 || p[2] == 0xAF;
+            }
+            return p[1] == 0x81 && p[2] == 0x9F;
+        case 0xE3: return p[1] == 0x80 && p[2] == 0x80;
+        default:   return false;
+    }
+}
+
+bool isAsciiSpace(Byte c) noexcept
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Length of the space character starting at p[0], or 0.
+qsizetype leadingSpace(const Byte* p, qsizetype size) noexcept
+{
+    if (isAsciiSpace(p[0])) return 1;
+    if (size >= 2 && p[0] == 0xC2 && (p[1] == 0x85 || p[1] == 0xA0)) return 2;
+    if (size >= 3 && isSpace3(p)) return 3;
+    return 0;
+}
+
+// Length of the space character ending at p[size - 1], or 0.
+qsizetype trailingSpace(const Byte* p, qsizetype size) noexcept
+{
+    const Byte last = p[size - 1];
+    if (isAsciiSpace(last)) return 1;
+    if (size >= 2 && p[size - 2] == 0xC2 && (last == 0x85 || last == 0xA0)) return 2;
+    if (size >= 3 && isSpace3(p + size - 3)) return 3;
+    return 0;
+}
+
+bool isContinuation(Byte c) noexcept
+{
+    return (c & 0xC0) == 0x80;
+}
+
+// First byte at or after `p` that is not ASCII, or `end`. 32 bytes per step
+// while everything is ASCII, which is almost every playlist line.
+const Byte* skipAscii(const Byte* p, const Byte* const end) noexcept
+{
+#if LE_UTF8_SSE2
+    for (; end - p >= 32; p += 32) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) break;
+    }
+    for (; end - p >= 16; p += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (mask != 0) {
+            return p + std::countr_zero(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    for (; end - p >= 8; p += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (word & kHighBits) break;
+    }
+    while (p < end && *p < 0x80) {
+        ++p;
+    }
+    return p;
+}
+
+// Windows-1252 code points for 0x80–0x9F; the rest of the code page is
+// Latin-1. The five unassigned bytes map to the C1 controls, as in browsers.
+constexpr char16_t kWindows1252[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+} // namespace
+
+bool isAscii(QByteArrayView bytes) noexcept
+{
+    const Byte* const p = reinterpret_cast<const Byte*>(bytes.data());
+    return skipAscii(p, p + bytes.size()) == p + bytes.size();
+}
+
+// Follows the well-formed byte sequences of Unicode, table 3-7.
+bool isValid(QByteArrayView bytes) noexcept
+{
+    const Byte* p = reinterpret_cast<const Byte*>(bytes.data());
+    const Byte* const end = p + bytes.size();
+
+    while (p < end) {
+        p = skipAscii(p, end);
+        if (p == end) break;
+
+        const Byte lead = *p;
+        const qsizetype left = end - p;
+
+        if (lead < 0x80) {
+            ++p;
+        } else if (lead < 0xC2) {
+            return false;                               // Continuation byte or overlong
+        } else if (lead < 0xE0) {
+            if (left < 2 || !isContinuation(p[1])) return false;
+            p += 2;
+        } else if (lead < 0xF0) {
+            const Byte lo = (lead == 0xE0) ? 0xA0 : 0x80;     // Overlong
+            const Byte hi = (lead == 0xED) ? 0x9F : 0xBF;     // Surrogates
+            if (left < 3 || p[1] < lo || p[1] > hi || !isContinuation(p[2])) return false;
+            p += 3;
+        } else if (lead < 0xF5) {
+            const Byte lo = (lead == 0xF0) ? 0x90 : 0x80;     // Overlong
+            const Byte hi = (lead == 0xF4) ? 0x8F : 0xBF;     // Above U+10FFFF
+            if (left < 4 || p[1] < lo || p[1] > hi || !isContinuation(p[2]) || !isContinuation(p[3])) {
+                return false;
+            }
+            p += 4;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendFromWindows1252(QByteArrayView bytes, QByteArray& out)
+{
+    const Byte* p = reinterpret_cast<const Byte*>(bytes.data());
+    const Byte* const end = p + bytes.size();
+    out.reserve(out.size() + 3 * bytes.size());
+
+    while (p < end) {
+        const Byte* const ascii = skipAscii(p, end);
+        out.append(reinterpret_cast<const char*>(p), ascii - p);
+        if (ascii == end) break;
+
+        const char16_t c = (*ascii < 0xA0) ? kWindows1252[*ascii - 0x80] : char16_t(*ascii);
+        if (c < 0x800) {
+            out.append(char(0xC0 | (c >> 6)));
+            out.append(char(0x80 | (c & 0x3F)));
+        } else {
+            out.append(char(0xE0 | (c >> 12)));
+            out.append(char(0x80 | ((c >> 6) & 0x3F)));
+            out.append(char(0x80 | (c & 0x3F)));
+        }
+        p = ascii + 1;
+    }
+}
+
+QByteArrayView trimmed(QByteArrayView bytes) noexcept
+{
+    const Byte* const p = reinterpret_cast<const Byte*>(bytes.data());
+    qsizetype begin = 0;
+    qsizetype end = bytes.size();
+
+    while (begin < end) {
+        const qsizetype n = leadingSpace(p + begin, end - begin);
+        if (n == 0) break;
+        begin += n;
+    }
+    while (end > begin) {
+        const qsizetype n = trailingSpace(p + begin, end - begin);
+        if (n == 0) break;
+        end -= n;
+    }
+    return bytes.sliced(begin, end - begin);
+}
+
+} // namespace LE::Utf8
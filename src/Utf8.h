@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+namespace LE::Utf8 {
+
+// Byte-level helpers that let the conversion pipeline work on UTF-8 directly
+// instead of decoding every line to UTF-16 and encoding it back.
+
+// True if every byte is below 0x80. Checks 32 bytes at a time with SSE2.
+bool isAscii(QByteArrayView bytes) noexcept;
+
+// Strict UTF-8 validation (no overlong forms, surrogates or code points above
+// U+10FFFF). Valid input decodes losslessly, so it can be passed through as is;
+// anything else must go through QStringDecoder to get Qt's U+FFFD replacement.
+bool isValid(QByteArrayView bytes) noexcept;
+
+// Byte-level QStringView::trimmed() for valid UTF-8: strips the same
+// characters QChar::isSpace() accepts, including U+00A0, U+3000 and the other
+// Unicode space separators.
+QByteArrayView trimmed(QByteArrayView bytes) noexcept;
+
+// Appends `bytes`, read as Windows-1252, to `out` as UTF-8. Every byte
+// sequence is valid Windows-1252, so nothing is replaced.
+void appendFromWindows1252(QByteArrayView bytes, QByteArray& out);
+
+} // namespace LE::Utf8
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Tracer.h"
 
 #include <QApplication>
 #include <QLoggingCategory>
@@ -32,6 +33,9 @@ int main(int argc, char* argv[])
     );
 #endif
 
+    // LE_TRACE=<file> records a Chrome trace of the session into <file>.
+    const LE::TraceSession trace(qEnvironmentVariable("LE_TRACE"));
+
     LE::MainWindow window;
     window.show();
 
@@ -0,0 +1,130 @@
+// IncrementalConverter after edits must write what a full conversion writes.
+
+#include "Converter.h"
+#include "IncrementalConverter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtTest>
+
+using namespace LE;
+
+namespace {
+
+QByteArray readAll(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readAll();
+}
+
+bool writeLines(const QString& path, const QByteArrayList& lines)
+{
+    const QByteArray text = lines.join('\n') + '\n';
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(text) == text.size();
+}
+
+// Entries with #EXTINF lines and some repeats, enough for many blocks of
+// about 2^kBoundaryBits entries each.
+QByteArrayList playlistLines(int entries)
+{
+    QRandomGenerator random(0x4C47);
+    QByteArrayList lines{"#EXTM3U"};
+    for (int i = 0; i < entries; ++i) {
+        if (random.bounded(2) == 0) {
+            lines += "#EXTINF:" + QByteArray::number(random.bounded(600)) + ",Track " + QByteArray::number(i);
+        }
+        const int track = random.bounded(8) == 0 ? random.bounded(i + 1) : i;
+        lines += "Music/Artist " + QByteArray::number(track % 97) + "//Album\\" + QByteArray::number(track) + ".mp3";
+    }
+    return lines;
+}
+
+} // namespace
+
+class IncrementalConverterTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void updatesMatchAFullConversion_data();
+    void updatesMatchAFullConversion();
+};
+
+void IncrementalConverterTest::updatesMatchAFullConversion_data()
+{
+    QTest::addColumn<QString>("extension");
+    QTest::addColumn<bool>("dedup");
+
+    QTest::newRow("m3u")         << "m3u"  << false;
+    QTest::newRow("m3u, dedup")  << "m3u"  << true;
+    QTest::newRow("m3u8")        << "m3u8" << false;
+    QTest::newRow("m3u8, dedup") << "m3u8" << true;
+}
+
+// The full conversion writes into a folder of its own under the same file
+// name, since an M3U8 header names its file.
+void IncrementalConverterTest::updatesMatchAFullConversion()
+{
+    QFETCH(QString, extension);
+    QFETCH(bool, dedup);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkdir("watched"));
+    QVERIFY(QDir(dir.path()).mkdir("fresh"));
+
+    const QString outputName = extension == "m3u" ? "list.m3u8" : "list.m3u";
+    ConversionParams params;
+    params.inputPath  = dir.filePath("list." + extension);
+    params.outputPath = dir.filePath("watched/" + outputName);
+    params.basePath   = "D:\\Music";
+    params.dedup      = dedup;
+
+    ConversionParams fresh = params;
+    fresh.outputPath = dir.filePath("fresh/" + outputName);
+
+    QByteArrayList lines = playlistLines(5000);
+    QVERIFY(writeLines(params.inputPath, lines));
+
+    IncrementalConverter converter(params);
+    const auto first = converter.update();
+    QVERIFY(first.written);
+    QVERIFY(first.blocks > 20);
+    QCOMPARE(first.blocksConverted, first.blocks);
+
+    const auto check = [&](const char* step) {
+        const auto result = converter.update();
+        QVERIFY2(result.written, step);
+        QVERIFY2(result.blocksConverted < result.blocks / 2, step);
+
+        Converter().convert(fresh);
+        QVERIFY2(readAll(params.outputPath) == readAll(fresh.outputPath), step);
+    };
+
+    lines[2500] = "Music/Edited//Album\\Edited.mp3";
+    QVERIFY(writeLines(params.inputPath, lines));
+    check("edit");
+    if (QTest::currentTestFailed()) return;
+
+    lines.insert(4000, "#EXTINF:99,Inserted");
+    lines.insert(4001, "Music/Inserted\\One.mp3");
+    lines.insert(4002, lines[10]);                      // A repeat for dedup
+    QVERIFY(writeLines(params.inputPath, lines));
+    check("insert");
+    if (QTest::currentTestFailed()) return;
+
+    lines.remove(1200, 40);
+    QVERIFY(writeLines(params.inputPath, lines));
+    check("delete");
+    if (QTest::currentTestFailed()) return;
+
+    QVERIFY(!converter.update().written);
+}
+
+QTEST_GUILESS_MAIN(IncrementalConverterTest)
+#include "IncrementalConverterTest.moc"
@@ -0,0 +1,79 @@
+// parallelFor: every index runs exactly once, and exceptions reach the
+// caller instead of terminating a pool thread.
+
+#include "Parallel.h"
+
+#include <QThreadPool>
+#include <QtTest>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace LE;
+
+class ParallelTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void runsEveryIndexOnce();
+    void rethrowsOnTheCallingThread();
+    void stopsHandingOutIndicesAfterAThrow();
+};
+
+void ParallelTest::runsEveryIndexOnce()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+
+    std::vector<std::atomic<int>> runs(10000);
+    parallelFor(static_cast<int>(runs.size()), [&](int i) { ++runs[static_cast<std::size_t>(i)]; }, &pool);
+
+    for (const auto& count : runs) {
+        QCOMPARE(count.load(), 1);
+    }
+}
+
+// Every index throws, so the calling thread and the helpers all fail.
+void ParallelTest::rethrowsOnTheCallingThread()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+
+    bool caught = false;
+    try {
+        parallelFor(64, [](int i) {
+            std::this_thread::yield();
+            throw std::runtime_error("index " + std::to_string(i));
+        }, &pool);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    QVERIFY(caught);
+
+    // The helpers are done with the frame of the call that threw.
+    QVERIFY(pool.waitForDone(5000));
+}
+
+void ParallelTest::stopsHandingOutIndicesAfterAThrow()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+
+    constexpr int kCount = 100000;
+    std::atomic<int> started{0};
+    try {
+        parallelFor(kCount, [&](int i) {
+            ++started;
+            if (i == 10) throw std::runtime_error("stop");
+        }, &pool);
+        QFAIL("parallelFor did not rethrow");
+    } catch (const std::runtime_error&) {
+    }
+    QVERIFY(started.load() < kCount);
+}
+
+QTEST_GUILESS_MAIN(ParallelTest)
+#include "ParallelTest.moc"
@@ -0,0 +1,132 @@
+// Checks every PathKernels implementation this CPU can run against the
+// scalar reference, on fixed cases and on random separator-heavy inputs.
+
+#include "PathKernels.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+#include <string>
+#include <vector>
+
+using namespace LE;
+
+namespace {
+
+// Separators are drawn often enough that runs of every length, and runs
+// across the vector block boundaries, are common.
+template <typename Char>
+std::basic_string<Char> randomPath(QRandomGenerator& random, qsizetype size)
+{
+    static constexpr char16_t kAlphabet[] = {u'/', u'\\', u'/', u'\\', u'a', u'Z', u'.', u' ', u'0'};
+
+    std::basic_string<Char> path;
+    path.reserve(static_cast<std::size_t>(size));
+    for (qsizetype i = 0; i < size; ++i) {
+        const auto pick = random.bounded(static_cast<int>(std::size(kAlphabet)) + 1);
+        if (pick < static_cast<int>(std::size(kAlphabet))) {
+            path.push_back(static_cast<Char>(kAlphabet[pick]));
+        } else if constexpr (sizeof(Char) == 2) {
+            path.push_back(u'é');
+        } else {
+            path.append("\xC3\xA9");    // é: bytes above 0x7F must pass untouched
+        }
+    }
+    return path;
+}
+
+template <typename Char, typename Kernel>
+std::basic_string<Char> collapse(Kernel kernel, const std::basic_string<Char>& in)
+{
+    std::basic_string<Char> out(in.size(), Char(0));
+    out.resize(static_cast<std::size_t>(kernel(in.data(), static_cast<qsizetype>(in.size()), out.data())));
+    return out;
+}
+
+} // namespace
+
+class PathKernelsTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void fixedCases_data();
+    void fixedCases();
+    void randomUtf16MatchesScalar();
+    void randomUtf8MatchesScalar();
+    void activeKernelIsListedLast();
+};
+
+void PathKernelsTest::fixedCases_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("empty")      << "" << "";
+    QTest::newRow("plain")      << "Artist\\Album\\01.mp3" << "Artist\\Album\\01.mp3";
+    QTest::newRow("slashes")    << "Artist/Album/01.mp3" << "Artist\\Album\\01.mp3";
+    QTest::newRow("runs")       << "a//b\\\\/c" << "a\\b\\c";
+    QTest::newRow("trailing")   << "a/b//" << "a\\b";
+    QTest::newRow("only seps")  << "/\\//" << "";
+    QTest::newRow("leading")    << "//server/share" << "\\server\\share";
+    QTest::newRow("long")       << QString(40, u'x') + "///" + QString(40, u'y') + "/"
+                                << QString(40, u'x') + "\\" + QString(40, u'y');
+}
+
+void PathKernelsTest::fixedCases()
+{
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+
+    const std::u16string in16 = input.toStdU16String();
+    const std::string    in8  = input.toStdString();
+
+    for (const PathKernels::Implementation& impl : PathKernels::implementations()) {
+        QCOMPARE(QString::fromStdU16String(collapse(impl.utf16, in16)), expected);
+        QCOMPARE(QString::fromStdString(collapse(impl.utf8, in8)), expected);
+    }
+}
+
+void PathKernelsTest::randomUtf16MatchesScalar()
+{
+    QRandomGenerator random(0x4C45);
+    const auto impls = PathKernels::implementations();
+
+    for (int round = 0; round < 20000; ++round) {
+        const auto in = randomPath<char16_t>(random, random.bounded(160));
+        const auto reference = collapse(impls.front().utf16, in);
+        for (const PathKernels::Implementation& impl : impls) {
+            if (collapse(impl.utf16, in) != reference) {
+                QFAIL(qPrintable(QString("%1 differs from scalar on \"%2\"")
+                                     .arg(impl.name, QString::fromStdU16String(in))));
+            }
+        }
+    }
+}
+
+void PathKernelsTest::randomUtf8MatchesScalar()
+{
+    QRandomGenerator random(0x4C46);
+    const auto impls = PathKernels::implementations();
+
+    for (int round = 0; round < 20000; ++round) {
+        const auto in = randomPath<char>(random, random.bounded(160));
+        const auto reference = collapse(impls.front().utf8, in);
+        for (const PathKernels::Implementation& impl : impls) {
+            if (collapse(impl.utf8, in) != reference) {
+                QFAIL(qPrintable(QString("%1 differs from scalar on \"%2\"")
+                                     .arg(impl.name, QString::fromStdString(in))));
+            }
+        }
+    }
+}
+
+void PathKernelsTest::activeKernelIsListedLast()
+{
+    const auto impls = PathKernels::implementations();
+    QVERIFY(!impls.empty());
+    QCOMPARE(QByteArray(impls.front().name), QByteArray("scalar"));
+    QCOMPARE(QByteArray(impls.back().name), QByteArray(PathKernels::activeKernelName()));
+}
+
+QTEST_GUILESS_MAIN(PathKernelsTest)
+#include "PathKernelsTest.moc"
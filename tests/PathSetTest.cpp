@@ -0,0 +1,83 @@
+// PathSet compares paths as Windows does; PathPool stores each fragment once.
+
+#include "PathPool.h"
+#include "PathSet.h"
+
+#include <QtTest>
+
+using namespace LE;
+
+namespace {
+
+QByteArray keyOf(QByteArrayView path)
+{
+    QByteArray key;
+    PathSet::appendKey(path, key);
+    return key;
+}
+
+} // namespace
+
+class PathSetTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void poolInternsEachFragmentOnce();
+    void samePathAsWindowsSeesIt();
+    void sameNameInOtherDirectoriesIsNew();
+    void manyPathsSurviveGrowth();
+};
+
+void PathSetTest::poolInternsEachFragmentOnce()
+{
+    PathPool pool;
+    const PathPool::Id album = pool.intern("d:\\music\\album\\");
+    QCOMPARE(pool.intern("d:\\music\\other\\"), PathPool::Id(1));
+    QCOMPARE(pool.intern("d:\\music\\album\\"), album);
+    QCOMPARE(pool.intern(""), PathPool::Id(2));
+    QCOMPARE(pool.size(), qsizetype(3));
+    QCOMPARE(pool.text(album).toByteArray(), QByteArray("d:\\music\\album\\"));
+    QVERIFY(pool.text(2).isEmpty());
+}
+
+void PathSetTest::samePathAsWindowsSeesIt()
+{
+    PathSet set;
+    QVERIFY(set.insert(keyOf("D:\\Music\\Album\\01 Track.mp3")));
+    QVERIFY(!set.insert(keyOf("d:/music//album/01 TRACK.MP3")));
+    QVERIFY(!set.insert(keyOf("D:\\Music\\Album\\01 Track.mp3\\")));
+    QVERIFY(set.insert(keyOf("\xC3\x89t\xC3\xA9\\01.mp3")));            // Été
+    QVERIFY(!set.insert(keyOf("\xC3\xA9T\xC3\x89/01.MP3")));            // éTÉ
+    QCOMPARE(set.size(), qsizetype(2));
+}
+
+void PathSetTest::sameNameInOtherDirectoriesIsNew()
+{
+    PathSet set;
+    QVERIFY(set.insert(keyOf("A\\01.mp3")));
+    QVERIFY(set.insert(keyOf("B\\01.mp3")));
+    QVERIFY(set.insert(keyOf("01.mp3")));
+    QVERIFY(set.insert(keyOf("A\\B\\01.mp3")));
+    QVERIFY(set.insert(keyOf("A\\01.mp3\\x")));
+    QVERIFY(!set.insert(keyOf("a\\01.mp3")));
+    QCOMPARE(set.size(), qsizetype(5));
+}
+
+void PathSetTest::manyPathsSurviveGrowth()
+{
+    PathSet set;
+    constexpr int kAlbums = 500, kTracks = 40;
+    for (int round = 0; round < 2; ++round) {
+        for (int album = 0; album < kAlbums; ++album) {
+            for (int track = 0; track < kTracks; ++track) {
+                const QByteArray path = "D:\\Music\\Album " + QByteArray::number(album)
+                                      + "\\" + QByteArray::number(track) + ".mp3";
+                QCOMPARE(set.insert(keyOf(path)), round == 0);
+            }
+        }
+    }
+    QCOMPARE(set.size(), qsizetype(kAlbums * kTracks));
+}
+
+QTEST_GUILESS_MAIN(PathSetTest)
+#include "PathSetTest.moc"
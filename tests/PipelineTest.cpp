@@ -0,0 +1,221 @@
+// Pipeline behaviour that must not depend on how the input is cut into
+// batches, or on which Execution runs the stages.
+
+#include "EntryTransforms.h"
+#include "OutputWriter.h"
+#include "PathValidator.h"
+#include "Pipeline.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+
+using namespace LE;
+
+namespace {
+
+using NormalizeKernel = EntryKernel<NormalizeSeparators>;
+using M3uKernel       = EntryKernel<StripMusicPrefix, NormalizeSeparators>;
+
+constexpr Pipeline::Execution kExecutions[] = {
+    Pipeline::Execution::Inline,
+    Pipeline::Execution::Threaded,
+    Pipeline::Execution::Chunked,
+};
+
+QByteArray convert(const Pipeline& pipeline, QByteArrayView input, Pipeline::Execution execution)
+{
+    QBuffer device;
+    device.open(QIODevice::WriteOnly);
+
+    ConversionHooks hooks;
+    JobMonitor monitor(hooks, input.size());
+    OutputWriter out(device);
+    pipeline.run(input, out, monitor, execution);
+    out.finish();
+    return device.data();
+}
+
+// Output lines without their terminators, whatever the platform writes.
+QByteArrayList outputLines(const QByteArray& output)
+{
+    QByteArrayList lines = output.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    for (QByteArray& line : lines) {
+        if (line.endsWith('\r')) line.chop(1);
+    }
+    return lines;
+}
+
+// `count` entries with no directives, so that the next line of the input
+// is line `count` + 1: the first of the second batch for kBatchLines.
+QByteArray plainEntries(qsizetype count, QByteArrayView name)
+{
+    QByteArray text;
+    for (qsizetype i = 0; i < count; ++i) {
+        text += name;
+        text += '\n';
+    }
+    return text;
+}
+
+// A few MiB of everything the stages treat differently: #EXTINF and other
+// directives, blank lines, CRLF, messy separators, non-ASCII and
+// Windows-1252 names, and repeated entries. Large enough for several chunks.
+QByteArray mixedPlaylist(int entries)
+{
+    QRandomGenerator random(0x4C45);
+    QByteArrayList seen;
+    QByteArray text = "\xEF\xBB\xBF#EXTM3U\n";
+
+    for (int i = 0; i < entries; ++i) {
+        const QByteArray eol = random.bounded(8) == 0 ? "\r\n" : "\n";
+        if (random.bounded(3) == 0) text += "#EXTINF:" + QByteArray::number(i % 300) + ",Track " + QByteArray::number(i) + eol;
+        if (random.bounded(20) == 0) text += "# comment" + eol;
+        if (random.bounded(20) == 0) text += "  " + eol;
+
+        QByteArray path;
+        if (!seen.isEmpty() && random.bounded(10) == 0) {
+            path = seen[random.bounded(static_cast<int>(seen.size()))];
+        } else {
+            path = "Music/Artist " + QByteArray::number(random.bounded(200));
+            path += random.bounded(4) == 0 ? "//" : "/";
+            path += random.bounded(6) == 0 ? "Alb\xC3\xBCm " : "Album ";
+            path += QByteArray::number(random.bounded(50)) + "\\";
+            path += random.bounded(50) == 0 ? "Caf\xE9 " : "Track ";     // Not UTF-8: read as Windows-1252
+            path += QByteArray::number(i) + ".mp3";
+            seen += path;
+        }
+        text += path + eol;
+    }
+    return text;
+}
+
+} // namespace
+
+class PipelineTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void executionsAgree_data();
+    void executionsAgree();
+    void chunksConcatenateToTheWholeRun();
+    void dropKeepsDirectivesWithTheirEntryAcrossBatches();
+    void dedupKeepsDirectivesWithTheirEntryAcrossBatches();
+};
+
+void PipelineTest::executionsAgree_data()
+{
+    QTest::addColumn<bool>("keepDirectives");
+    QTest::addColumn<bool>("dedup");
+
+    QTest::newRow("directives")         << true  << false;
+    QTest::newRow("entries only")       << false << false;
+    QTest::newRow("directives, dedup")  << true  << true;
+    QTest::newRow("entries only, dedup") << false << true;
+}
+
+void PipelineTest::executionsAgree()
+{
+    QFETCH(bool, keepDirectives);
+    QFETCH(bool, dedup);
+
+    const QByteArray input = mixedPlaylist(60000);
+    QVERIFY(input.size() > 2 * Pipeline::kChunkBytes);
+
+    PipelineOptions options;
+    options.outputPrefix   = "D:\\Music\\";
+    options.keepDirectives = keepDirectives;
+    options.dedup          = dedup;
+    const Pipeline pipeline(TransformKernel::of<M3uKernel>(), options);
+
+    const QByteArray expected = convert(pipeline, input, Pipeline::Execution::Inline);
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(convert(pipeline, input, Pipeline::Execution::Threaded), expected);
+    QCOMPARE(convert(pipeline, input, Pipeline::Execution::Chunked), expected);
+}
+
+// Pieces cut at entryBoundary() convert independently (IncrementalConverter).
+void PipelineTest::chunksConcatenateToTheWholeRun()
+{
+    const QByteArray input = mixedPlaylist(20000);
+
+    PipelineOptions options;
+    options.outputPrefix = "D:\\Music\\";
+    const Pipeline pipeline(TransformKernel::of<M3uKernel>(), options);
+
+    const QByteArrayView body = QByteArrayView(input).sliced(3);    // runChunk leaves the BOM to the caller
+    ConversionHooks hooks;
+    JobMonitor monitor(hooks, body.size());
+    MemorySink pieces;
+    for (qsizetype pos = 0; pos < body.size();) {
+        const qsizetype nl = body.indexOf('\n', std::min(pos + 4000, body.size() - 1));
+        const qsizetype end = (nl < 0) ? body.size() : pipeline.entryBoundary(body, nl + 1);
+        pipeline.runChunk(body.sliced(pos, end - pos), pieces, monitor);
+        pos = end;
+    }
+
+    QCOMPARE(pieces.bytes(), convert(pipeline, input, Pipeline::Execution::Inline));
+}
+
+// The #EXTINF of a missing entry is the last line of the first batch; the
+// entry itself would be the first line of the second.
+void PipelineTest::dropKeepsDirectivesWithTheirEntryAcrossBatches()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile present(dir.filePath("present.mp3"));
+    QVERIFY(present.open(QIODevice::WriteOnly));
+    present.close();
+
+    QByteArray input = plainEntries(Pipeline::kBatchLines - 1, "present.mp3");
+    input += "#EXTINF:1,Missing\n";
+    input += "missing.mp3\n";
+    input += "present.mp3\n";
+
+    PathValidator validator(dir.path());
+    PipelineOptions options;
+    options.validation = ValidationMode::Drop;
+    options.validator  = &validator;
+    const Pipeline pipeline(TransformKernel::of<NormalizeKernel>(), options);
+
+    for (const Pipeline::Execution execution : kExecutions) {
+        const QByteArrayList lines = outputLines(convert(pipeline, input, execution));
+        QVERIFY2(!lines.contains("#EXTINF:1,Missing"), qPrintable(Pipeline::executionName(execution)));
+        QVERIFY2(!lines.contains("missing.mp3"), qPrintable(Pipeline::executionName(execution)));
+        QCOMPARE(lines.size(), Pipeline::kBatchLines);
+    }
+}
+
+// Same with a repeated entry: its #EXTINF ends the first batch.
+void PipelineTest::dedupKeepsDirectivesWithTheirEntryAcrossBatches()
+{
+    QByteArray input = "repeated.mp3\n";
+    for (qsizetype i = 1; i < Pipeline::kBatchLines - 1; ++i) {
+        input += "track " + QByteArray::number(i) + ".mp3\n";
+    }
+    input += "#EXTINF:1,Repeated\n";
+    input += "repeated.mp3\n";
+    input += "last.mp3\n";
+
+    PipelineOptions options;
+    options.dedup = true;
+    const Pipeline pipeline(TransformKernel::of<NormalizeKernel>(), options);
+
+    for (const Pipeline::Execution execution : kExecutions) {
+        const QByteArrayList lines = outputLines(convert(pipeline, input, execution));
+        QVERIFY2(!lines.contains("#EXTINF:1,Repeated"), qPrintable(Pipeline::executionName(execution)));
+        QCOMPARE(lines.count("repeated.mp3"), qsizetype(1));
+        QCOMPARE(lines.last(), QByteArray("last.mp3"));
+        QCOMPARE(lines.size(), Pipeline::kBatchLines);
+    }
+}
+
+QTEST_GUILESS_MAIN(PipelineTest)
+#include "PipelineTest.moc"
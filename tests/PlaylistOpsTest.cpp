@@ -0,0 +1,311 @@
+// Sort, merge and split: spilled runs must give what an in-memory sort
+// gives, and both must be a stable sort by PathSet key.
+
+#include "PathSet.h"
+#include "PlaylistOps.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+using namespace LE;
+
+namespace {
+
+// Memory small enough for a few dozen records per run, so the inputs below
+// spill more runs than are merged at once (64).
+constexpr qint64 kTinyBudget = qint64(8) << 10;
+
+struct Record {
+    QByteArray key;
+    QByteArrayList lines;   // Directives, then the entry
+};
+
+// Records with #EXTINF lines, repeated paths spelled with other cases and
+// separators, and a unique #EXTINF title per record so that the order of
+// records with equal paths shows in the output.
+std::vector<Record> randomRecords(QRandomGenerator& random, int count, int distinctPaths, const char* tag)
+{
+    std::vector<Record> records;
+    records.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const int path = random.bounded(distinctPaths);
+        QByteArray entry = "Music/Artist " + QByteArray::number(path % 61) + "/Track "
+                         + QByteArray::number(path) + ".mp3";
+        switch (random.bounded(4)) {
+            case 0: entry = entry.toUpper(); break;
+            case 1: entry.replace('/', "\\\\"); break;
+            default: break;
+        }
+
+        Record record;
+        if (random.bounded(4) != 0) {
+            record.lines += "#EXTINF:" + QByteArray::number(random.bounded(600)) + "," + tag
+                          + QByteArray::number(i);
+        }
+        if (random.bounded(30) == 0) {
+            record.lines += "# comment " + QByteArray::number(i);
+        }
+        record.lines += entry;
+        PathSet::appendKey(entry, record.key);
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+bool writePlaylist(const QString& path, bool header, const std::vector<Record>& records,
+                   QByteArrayView trailer = {})
+{
+    QByteArray text = header ? "#EXTM3U\n" : "";
+    for (const Record& record : records) {
+        text += record.lines.join('\n') + '\n';
+    }
+    text += trailer;
+
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(text) == text.size();
+}
+
+// Output lines without their terminators, whatever the platform writes.
+QByteArrayList readLines(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QByteArrayList lines = file.readAll().split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    for (QByteArray& line : lines) {
+        if (line.endsWith('\r')) line.chop(1);
+    }
+    return lines;
+}
+
+// What a stable sort by key writes, optionally keeping the first record of
+// every key only.
+QByteArrayList expectedLines(std::vector<Record> records, bool header, bool dedup)
+{
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return std::string_view(a.key.constData(), a.key.size()) < std::string_view(b.key.constData(), b.key.size());
+    });
+
+    QByteArrayList lines;
+    if (header) lines += "#EXTM3U";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        if (dedup && i > 0 && records[i].key == records[i - 1].key) continue;
+        lines += records[i].lines;
+    }
+    return lines;
+}
+
+qint64 distinctKeys(const std::vector<Record>& records)
+{
+    QSet<QByteArray> keys;
+    for (const Record& record : records) keys.insert(record.key);
+    return keys.size();
+}
+
+qsizetype entriesIn(const QByteArrayList& lines)
+{
+    return std::count_if(lines.cbegin(), lines.cend(), [](const QByteArray& line) { return !line.startsWith('#'); });
+}
+
+} // namespace
+
+class PlaylistOpsTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void spilledSortMatchesInMemorySort_data();
+    void spilledSortMatchesInMemorySort();
+    void mergeKeepsInputOrderForEqualPaths();
+    void presortedMergeThrowsOnDisorder();
+    void headerOnlyIfAnInputHasOne();
+    void splitCutsEqualParts();
+};
+
+void PlaylistOpsTest::spilledSortMatchesInMemorySort_data()
+{
+    QTest::addColumn<bool>("dedup");
+    QTest::newRow("all records") << false;
+    QTest::newRow("dedup")       << true;
+}
+
+void PlaylistOpsTest::spilledSortMatchesInMemorySort()
+{
+    QFETCH(bool, dedup);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QRandomGenerator random(0x4C48);
+    const std::vector<Record> records = randomRecords(random, 12000, 3000, "Title ");
+    const QString input = dir.filePath("list.m3u8");
+    QVERIFY(writePlaylist(input, true, records, "#EXTINF:1,No entry follows\n"));
+
+    SortOptions options;
+    options.dedup = dedup;
+    options.tempDir = dir.path();
+
+    const SortStats inMemory = PlaylistOps::sort(input, dir.filePath("memory.m3u8"), options);
+    QCOMPARE(inMemory.runs, qint64(0));
+
+    options.memoryBudget = kTinyBudget;
+    const SortStats spilled = PlaylistOps::sort(input, dir.filePath("spilled.m3u8"), options);
+    QVERIFY2(spilled.runs > 64, qPrintable(QString::number(spilled.runs)));
+
+    const QByteArrayList expected = expectedLines(records, true, dedup);
+    QCOMPARE(readLines(dir.filePath("memory.m3u8")), expected);
+    QCOMPARE(readLines(dir.filePath("spilled.m3u8")), expected);
+
+    const qint64 written = dedup ? distinctKeys(records) : qint64(records.size());
+    QCOMPARE(inMemory.records, written);
+    QCOMPARE(spilled.records, written);
+    QCOMPARE(inMemory.duplicates, qint64(records.size()) - written);
+    QCOMPARE(spilled.duplicates, qint64(records.size()) - written);
+
+    // Every run was removed with the sort that made it.
+    QCOMPARE(QDir(dir.path()).entryList({"le-run-*"}, QDir::Files).size(), qsizetype(0));
+}
+
+// Merged, spilled or not, and streamed from sorted inputs.
+void PlaylistOpsTest::mergeKeepsInputOrderForEqualPaths()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QRandomGenerator random(0x4C49);
+
+    std::vector<Record> all;
+    QStringList inputs;
+    QStringList sortedInputs;
+    for (int i = 0; i < 3; ++i) {
+        const std::vector<Record> records = randomRecords(random, 3000, 800, i == 0 ? "A" : i == 1 ? "B" : "C");
+        all.insert(all.end(), records.begin(), records.end());
+
+        inputs << dir.filePath(QString("in%1.m3u8").arg(i));
+        QVERIFY(writePlaylist(inputs.last(), i == 1, records));
+        sortedInputs << dir.filePath(QString("in%1.sorted.m3u8").arg(i));
+        PlaylistOps::sort(inputs.last(), sortedInputs.last());
+    }
+    const QByteArrayList expected = expectedLines(all, true, false);
+
+    SortOptions options;
+    options.tempDir = dir.path();
+    PlaylistOps::merge(inputs, dir.filePath("memory.m3u8"), options);
+    QCOMPARE(readLines(dir.filePath("memory.m3u8")), expected);
+
+    options.memoryBudget = kTinyBudget;
+    const SortStats spilled = PlaylistOps::merge(inputs, dir.filePath("spilled.m3u8"), options);
+    QVERIFY(spilled.runs > 64);
+    QCOMPARE(readLines(dir.filePath("spilled.m3u8")), expected);
+
+    options.presorted = true;
+    const SortStats streamed = PlaylistOps::merge(sortedInputs, dir.filePath("streamed.m3u8"), options);
+    QCOMPARE(streamed.runs, qint64(0));
+    QCOMPARE(readLines(dir.filePath("streamed.m3u8")), expected);
+
+    options.dedup = true;
+    const SortStats deduplicated = PlaylistOps::merge(sortedInputs, dir.filePath("dedup.m3u8"), options);
+    QCOMPARE(readLines(dir.filePath("dedup.m3u8")), expectedLines(all, true, true));
+    QCOMPARE(deduplicated.records, distinctKeys(all));
+}
+
+void PlaylistOpsTest::presortedMergeThrowsOnDisorder()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString sorted = dir.filePath("sorted.m3u");
+    const QString unsorted = dir.filePath("unsorted.m3u");
+    const QString output = dir.filePath("out.m3u");
+
+    QFile sortedFile(sorted);
+    QVERIFY(sortedFile.open(QIODevice::WriteOnly));
+    sortedFile.write("a.mp3\nB.mp3\nb.mp3\nc.mp3\n");       // B and b are equal
+    sortedFile.close();
+    QFile unsortedFile(unsorted);
+    QVERIFY(unsortedFile.open(QIODevice::WriteOnly));
+    unsortedFile.write("a.mp3\nc.mp3\nb.mp3\n");
+    unsortedFile.close();
+
+    SortOptions options;
+    options.presorted = true;
+    QCOMPARE(PlaylistOps::merge({sorted}, output, options).records, qint64(4));
+
+    bool threw = false;
+    try {
+        PlaylistOps::merge({sorted, unsorted}, output, options);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+    QCOMPARE(readLines(output).size(), qsizetype(4));         // Left as it was
+}
+
+void PlaylistOpsTest::headerOnlyIfAnInputHasOne()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QRandomGenerator random(0x4C4A);
+    const std::vector<Record> first = randomRecords(random, 50, 50, "F");
+    const std::vector<Record> second = randomRecords(random, 50, 50, "S");
+    QVERIFY(writePlaylist(dir.filePath("plain.m3u"), false, first));
+    QVERIFY(writePlaylist(dir.filePath("header.m3u"), true, second));
+
+    PlaylistOps::sort(dir.filePath("plain.m3u"), dir.filePath("plain.sorted.m3u"));
+    QCOMPARE(readLines(dir.filePath("plain.sorted.m3u")), expectedLines(first, false, false));
+
+    std::vector<Record> both = first;
+    both.insert(both.end(), second.begin(), second.end());
+    PlaylistOps::merge({dir.filePath("plain.m3u"), dir.filePath("header.m3u")}, dir.filePath("both.m3u"));
+    QCOMPARE(readLines(dir.filePath("both.m3u")), expectedLines(both, true, false));
+}
+
+void PlaylistOpsTest::splitCutsEqualParts()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkdir("parts"));
+    QRandomGenerator random(0x4C4B);
+    const std::vector<Record> records = randomRecords(random, 1000, 1000, "T");
+    const QString input = dir.filePath("big.list.m3u8");
+    QVERIFY(writePlaylist(input, true, records, "#EXTINF:1,No entry follows\n"));
+
+    const QStringList parts = PlaylistOps::split(input, 300, dir.filePath("parts"));
+    const QStringList expectedNames = {
+        "big.list.part001.m3u8", "big.list.part002.m3u8", "big.list.part003.m3u8", "big.list.part004.m3u8",
+    };
+    QCOMPARE(parts.size(), expectedNames.size());
+
+    const qsizetype expectedEntries[] = {300, 300, 300, 100};
+    QByteArrayList joined{"#EXTM3U"};
+    for (qsizetype i = 0; i < parts.size(); ++i) {
+        QCOMPARE(parts[i], QDir(dir.filePath("parts")).filePath(expectedNames[i]));
+
+        QByteArrayList lines = readLines(parts[i]);
+        QVERIFY(!lines.isEmpty());
+        QCOMPARE(lines.takeFirst(), QByteArray("#EXTM3U"));
+        QCOMPARE(entriesIn(lines), expectedEntries[i]);
+        QVERIFY(!lines.last().startsWith('#'));
+        joined += lines;
+    }
+
+    // In order, and nothing lost but the directive after the last entry.
+    QByteArrayList original;
+    original += "#EXTM3U";
+    for (const Record& record : records) original += record.lines;
+    QCOMPARE(joined, original);
+
+    QCOMPARE(PlaylistOps::split(input, 1000, dir.filePath("parts")).size(), qsizetype(1));
+}
+
+QTEST_GUILESS_MAIN(PlaylistOpsTest)
+#include "PlaylistOpsTest.moc"
@@ -0,0 +1,210 @@
+// Playlist model, and directives surviving a conversion in both directions.
+
+#include "Converter.h"
+#include "Playlist.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+using namespace LE;
+
+namespace {
+
+QByteArray readAll(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readAll();
+}
+
+bool writeAll(const QString& path, QByteArrayView data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data.data(), data.size()) == data.size();
+}
+
+} // namespace
+
+class PlaylistTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void appendKeepsLinesInOrder();
+    void truncateDropsTheTail();
+    void clearKeepsNothing();
+    void parseTrimsAndSkipsBlankLines();
+    void directivesSurviveARoundTrip();
+    void headerIsGeneratedWhenMissing();
+};
+
+void PlaylistTest::appendKeepsLinesInOrder()
+{
+    Playlist lines;
+    lines.appendLine("#EXTM3U");
+    lines.appendLine("#EXTINF:213,Artist - Title");
+    lines.appendLine("Music/Artist/01.mp3");
+    lines.append(Playlist::Kind::Resolved, "D:\\Music\\Moved\\02.mp3");
+    lines.append(Playlist::Kind::Entry, "");
+
+    QCOMPARE(lines.size(), qsizetype(5));
+    QCOMPARE(lines.entryCount(), qsizetype(3));
+
+    QCOMPARE(lines.kind(0), Playlist::Kind::Directive);
+    QCOMPARE(lines.kind(2), Playlist::Kind::Entry);
+    QCOMPARE(lines.kind(3), Playlist::Kind::Resolved);
+    QVERIFY(!lines.isEntry(0));
+    QVERIFY(!lines.isEntry(1));
+    QVERIFY(lines.isEntry(2));
+    QVERIFY(lines.isEntry(3));     // A relinked entry is still an entry
+
+    QCOMPARE(lines.text(1).toByteArray(), QByteArray("#EXTINF:213,Artist - Title"));
+    QCOMPARE(lines.text(2).toByteArray(), QByteArray("Music/Artist/01.mp3"));
+    QCOMPARE(lines.text(3).toByteArray(), QByteArray("D:\\Music\\Moved\\02.mp3"));
+    QVERIFY(lines.text(4).isEmpty());
+}
+
+void PlaylistTest::truncateDropsTheTail()
+{
+    Playlist lines;
+    lines.appendLine("#EXTINF:1,One");
+    lines.appendLine("one.mp3");
+    lines.appendLine("#EXTINF:2,Two");
+    lines.appendLine("two.mp3");
+
+    lines.truncate(3);
+    QCOMPARE(lines.size(), qsizetype(3));
+    QCOMPARE(lines.entryCount(), qsizetype(1));
+    QCOMPARE(lines.text(2).toByteArray(), QByteArray("#EXTINF:2,Two"));
+
+    // Appending after a truncate reuses the space of the dropped lines.
+    lines.appendLine("three.mp3");
+    QCOMPARE(lines.entryCount(), qsizetype(2));
+    QCOMPARE(lines.text(3).toByteArray(), QByteArray("three.mp3"));
+
+    lines.truncate(0);
+    QCOMPARE(lines.size(), qsizetype(0));
+    QCOMPARE(lines.entryCount(), qsizetype(0));
+}
+
+void PlaylistTest::clearKeepsNothing()
+{
+    Playlist lines;
+    lines.appendLine("#EXTM3U");
+    lines.appendLine("one.mp3");
+    lines.clear();
+    QCOMPARE(lines.size(), qsizetype(0));
+    QCOMPARE(lines.entryCount(), qsizetype(0));
+
+    lines.appendLine("two.mp3");
+    QCOMPARE(lines.text(0).toByteArray(), QByteArray("two.mp3"));
+}
+
+void PlaylistTest::parseTrimsAndSkipsBlankLines()
+{
+    const Playlist lines = Playlist::parse("\xEF\xBB\xBF#EXTM3U\r\n"
+                                           "\r\n"
+                                           "  #EXTINF:-1,Caf\xE9  \n"
+                                           "\t Music/01.mp3 \n"
+                                           "   \n"
+                                           "02.mp3");
+
+    QCOMPARE(lines.size(), qsizetype(4));
+    QCOMPARE(lines.entryCount(), qsizetype(2));
+    QCOMPARE(lines.text(0).toByteArray(), QByteArray("#EXTM3U"));
+    QCOMPARE(lines.text(1).toByteArray(), QByteArray("#EXTINF:-1,Caf\xC3\xA9"));    // Read as Windows-1252
+    QVERIFY(!lines.isEntry(1));
+    QCOMPARE(lines.text(2).toByteArray(), QByteArray("Music/01.mp3"));
+    QCOMPARE(lines.text(3).toByteArray(), QByteArray("02.mp3"));
+}
+
+// M3U → M3U8 → M3U keeps every directive in front of the entry it
+// belongs to, #EXTM3U included, while the entries are rewritten.
+void PlaylistTest::directivesSurviveARoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString m3u = dir.filePath("list.m3u");
+    const QString m3u8 = dir.filePath("list.m3u8");
+    const QString back = dir.filePath("back.m3u");
+
+    QVERIFY(writeAll(m3u, "#EXTM3U\n"
+                          "#EXTINF:213,Artist - First\n"
+                          "Music/Artist/Album/01 First.mp3\n"
+                          "# A comment\n"
+                          "#EXTINF:187,Artist - \xC3\x89t\xC3\xA9\n"
+                          "Music/Artist//Album\\02 \xC3\x89t\xC3\xA9.mp3\n"
+                          "Other/03 No Prefix.mp3\n"
+                          "#EXTINF:-1,Stream\n"
+                          "Music/04 Last.mp3\n"));
+
+    ConversionParams toM3u8;
+    toM3u8.inputPath  = m3u;
+    toM3u8.outputPath = m3u8;
+    toM3u8.basePath   = "D:/Music/";
+    Converter().convert(toM3u8);
+
+    ConversionParams toM3u;
+    toM3u.inputPath  = m3u8;
+    toM3u.outputPath = back;
+    Converter().convert(toM3u);
+
+    const Playlist source = Playlist::parse(readAll(m3u));
+    const Playlist converted = Playlist::parse(readAll(m3u8));
+    const Playlist restored = Playlist::parse(readAll(back));
+
+    const QByteArrayList expectedEntries = {
+        "D:\\Music\\Artist\\Album\\01 First.mp3",
+        "D:\\Music\\Artist\\Album\\02 \xC3\x89t\xC3\xA9.mp3",
+        "D:\\Music\\Other\\03 No Prefix.mp3",
+        "D:\\Music\\04 Last.mp3",
+    };
+
+    QCOMPARE(converted.size(), source.size());
+    QCOMPARE(restored.size(), source.size());
+    qsizetype entry = 0;
+    for (qsizetype i = 0; i < source.size(); ++i) {
+        QCOMPARE(converted.isEntry(i), source.isEntry(i));
+        QCOMPARE(restored.isEntry(i), source.isEntry(i));
+        if (source.isEntry(i)) {
+            QCOMPARE(converted.text(i).toByteArray(), expectedEntries[entry]);
+            QCOMPARE(restored.text(i).toByteArray(), expectedEntries[entry]);
+            ++entry;
+        } else {
+            QCOMPARE(converted.text(i).toByteArray(), source.text(i).toByteArray());
+            QCOMPARE(restored.text(i).toByteArray(), source.text(i).toByteArray());
+        }
+    }
+    QCOMPARE(entry, qsizetype(expectedEntries.size()));
+}
+
+// An M3U8 always starts with #EXTM3U; the #EXTINF lines of the input stay
+// with their entries after the generated header.
+void PlaylistTest::headerIsGeneratedWhenMissing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString m3u = dir.filePath("mix.m3u");
+    const QString m3u8 = dir.filePath("mix.m3u8");
+
+    QVERIFY(writeAll(m3u, "#EXTINF:60,One\nMusic/one.mp3\ntwo.mp3\n"));
+
+    ConversionParams params;
+    params.inputPath  = m3u;
+    params.outputPath = m3u8;
+    params.basePath   = "E:\\Library";
+    Converter().convert(params);
+
+    const Playlist converted = Playlist::parse(readAll(m3u8));
+    QCOMPARE(converted.size(), qsizetype(5));
+    QCOMPARE(converted.text(0).toByteArray(), QByteArray("#EXTM3U"));
+    QCOMPARE(converted.text(1).toByteArray(), QByteArray("#mix.m3u8"));
+    QCOMPARE(converted.text(2).toByteArray(), QByteArray("#EXTINF:60,One"));
+    QCOMPARE(converted.text(3).toByteArray(), QByteArray("E:\\Library\\one.mp3"));
+    QCOMPARE(converted.text(4).toByteArray(), QByteArray("E:\\Library\\two.mp3"));
+}
+
+QTEST_GUILESS_MAIN(PlaylistTest)
+#include "PlaylistTest.moc"
@@ -0,0 +1,103 @@
+// SpscQueue: order, blocking at capacity, and close() on either side.
+
+#include "SpscQueue.h"
+
+#include <QtTest>
+
+#include <thread>
+#include <vector>
+
+using namespace LE;
+
+class SpscQueueTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void tryPushStopsAtCapacity();
+    void popDrainsThenFailsAfterClose();
+    void pushFailsAfterClose();
+    void closeWakesABlockedConsumer();
+    void transfersInOrderAcrossThreads();
+};
+
+void SpscQueueTest::tryPushStopsAtCapacity()
+{
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.tryPush(int(i)));
+    }
+    QVERIFY(!queue.tryPush(4));
+
+    int value = -1;
+    QVERIFY(queue.tryPop(value));
+    QCOMPARE(value, 0);
+    QVERIFY(queue.tryPush(4));
+}
+
+void SpscQueueTest::popDrainsThenFailsAfterClose()
+{
+    SpscQueue<int, 4> queue;
+    QVERIFY(queue.push(1));
+    QVERIFY(queue.push(2));
+    queue.close();
+
+    int value = 0;
+    QVERIFY(queue.pop(value));
+    QCOMPARE(value, 1);
+    QVERIFY(queue.pop(value));
+    QCOMPARE(value, 2);
+    QVERIFY(!queue.pop(value));
+    QVERIFY(!queue.tryPop(value));
+}
+
+void SpscQueueTest::pushFailsAfterClose()
+{
+    SpscQueue<int, 4> queue;
+    queue.close();
+    QVERIFY(!queue.push(1));
+    QVERIFY(!queue.tryPush(1));
+}
+
+void SpscQueueTest::closeWakesABlockedConsumer()
+{
+    SpscQueue<int, 2> queue;
+    bool popped = true;
+    std::thread consumer([&] {
+        int value = 0;
+        popped = queue.pop(value);
+    });
+
+    QTest::qWait(20);
+    queue.close();
+    consumer.join();
+    QVERIFY(!popped);
+}
+
+// Capacity 2 keeps the producer blocking on a full queue most of the time.
+void SpscQueueTest::transfersInOrderAcrossThreads()
+{
+    constexpr int kCount = 200000;
+    SpscQueue<std::vector<int>, 2> queue;
+
+    std::thread producer([&] {
+        for (int i = 0; i < kCount; ++i) {
+            if (!queue.push(std::vector<int>{i, -i})) return;
+        }
+        queue.close();
+    });
+
+    std::vector<int> batch;
+    int expected = 0;
+    bool inOrder = true;
+    while (queue.pop(batch)) {
+        inOrder = inOrder && batch.size() == 2 && batch[0] == expected && batch[1] == -expected;
+        ++expected;
+    }
+    producer.join();
+
+    QVERIFY(inOrder);
+    QCOMPARE(expected, kCount);
+}
+
+QTEST_GUILESS_MAIN(SpscQueueTest)
+#include "SpscQueueTest.moc"
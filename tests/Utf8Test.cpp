@@ -0,0 +1,144 @@
+// Utf8 byte helpers against Qt's own decoding and trimming.
+
+#include "Utf8.h"
+
+#include <QRandomGenerator>
+#include <QStringDecoder>
+#include <QtTest>
+
+#include <iterator>
+
+using namespace LE;
+
+namespace {
+
+// Random bytes weighted towards the lead and continuation bytes that make
+// or break a multi-byte sequence.
+QByteArray randomBytes(QRandomGenerator& random, int size)
+{
+    static constexpr unsigned char kInteresting[] = {
+        0x00, 0x20, 'a', 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF,
+    };
+
+    QByteArray bytes;
+    bytes.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        bytes += static_cast<char>(random.bounded(2) == 0
+            ? kInteresting[random.bounded(static_cast<int>(std::size(kInteresting)))]
+            : random.bounded(256));
+    }
+    return bytes;
+}
+
+// Valid UTF-8 made of code points from every encoded length, with a mix of
+// the spaces QChar::isSpace() accepts at both ends.
+QByteArray randomPaddedText(QRandomGenerator& random)
+{
+    static constexpr char32_t kSpaces[] = {
+        U' ', U'\t', U'\n', U'\r', U'\v', U'\f', U'\u0085', U'\u00A0', U'\u1680', U'\u2000',
+        U'\u2005', U'\u200A', U'\u2028', U'\u2029', U'\u202F', U'\u205F', U'\u3000',
+    };
+    // U+200B and U+FEFF look like spaces but are not trimmed.
+    static constexpr char32_t kText[] = {
+        U'a', U'/', U'\u00E9', U'\u00A1', U'\u200B', U'\u3001', U'\uFEFF', U'\U0001F3B5',
+    };
+
+    const auto pick = [&](const auto& pool, int count) {
+        QString text;
+        for (int i = 0; i < count; ++i) {
+            const char32_t ch = pool[random.bounded(static_cast<int>(std::size(pool)))];
+            text += QString::fromUcs4(&ch, 1);
+        }
+        return text;
+    };
+
+    return (pick(kSpaces, random.bounded(4)) + pick(kText, random.bounded(6))
+            + pick(kSpaces, random.bounded(4))).toUtf8();
+}
+
+} // namespace
+
+class Utf8Test : public QObject {
+    Q_OBJECT
+
+private slots:
+    void isValid_data();
+    void isValid();
+    void isValidMatchesQtOnRandomBytes();
+    void isAscii();
+    void trimmedMatchesQString();
+};
+
+void Utf8Test::isValid_data()
+{
+    QTest::addColumn<QByteArray>("bytes");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("empty")              << QByteArray() << true;
+    QTest::newRow("ascii")              << QByteArray("Music\\01.mp3") << true;
+    QTest::newRow("two bytes")          << QByteArray("\xC3\xA9") << true;
+    QTest::newRow("three bytes")        << QByteArray("\xE2\x82\xAC") << true;
+    QTest::newRow("four bytes")         << QByteArray("\xF0\x9F\x8E\xB5") << true;
+    QTest::newRow("max code point")     << QByteArray("\xF4\x8F\xBF\xBF") << true;
+    QTest::newRow("lone continuation")  << QByteArray("\x80") << false;
+    QTest::newRow("truncated")          << QByteArray("\xE2\x82") << false;
+    QTest::newRow("overlong slash")     << QByteArray("\xC0\xAF") << false;
+    QTest::newRow("overlong 3 bytes")   << QByteArray("\xE0\x80\xAF") << false;
+    QTest::newRow("surrogate")          << QByteArray("\xED\xA0\x80") << false;
+    QTest::newRow("above U+10FFFF")     << QByteArray("\xF4\x90\x80\x80") << false;
+    QTest::newRow("windows-1252")       << QByteArray("Caf\xE9") << false;
+    QTest::newRow("error past 32 bytes") << QByteArray(40, 'a') + "\xFF" << false;
+}
+
+void Utf8Test::isValid()
+{
+    QFETCH(QByteArray, bytes);
+    QFETCH(bool, valid);
+    QCOMPARE(Utf8::isValid(bytes), valid);
+}
+
+// Qt decodes invalid input with U+FFFD replacements, so valid input is
+// exactly what decodes without errors.
+void Utf8Test::isValidMatchesQtOnRandomBytes()
+{
+    QRandomGenerator random(0x4C45);
+    for (int round = 0; round < 50000; ++round) {
+        const QByteArray bytes = randomBytes(random, random.bounded(48));
+
+        // hasError() is set once the result is converted to a QString.
+        QStringDecoder decoder(QStringConverter::Utf8, QStringConverter::Flag::Stateless);
+        [[maybe_unused]] const QString decoded = decoder.decode(bytes);
+        const bool qtValid = !decoder.hasError();
+
+        if (Utf8::isValid(bytes) != qtValid) {
+            QFAIL(("Mismatch on " + bytes.toHex(' ')).constData());
+        }
+    }
+}
+
+void Utf8Test::isAscii()
+{
+    QVERIFY(Utf8::isAscii(""));
+    QVERIFY(Utf8::isAscii(QByteArray(100, 'x')));
+    for (int at = 0; at < 70; ++at) {
+        QByteArray bytes(70, 'x');
+        bytes[at] = '\x80';
+        QVERIFY2(!Utf8::isAscii(bytes), qPrintable(QString::number(at)));
+    }
+}
+
+void Utf8Test::trimmedMatchesQString()
+{
+    QRandomGenerator random(0x4C46);
+    for (int round = 0; round < 50000; ++round) {
+        const QByteArray bytes = randomPaddedText(random);
+        const QByteArray expected = QString::fromUtf8(bytes).trimmed().toUtf8();
+        if (Utf8::trimmed(bytes).toByteArray() != expected) {
+            QFAIL(("Mismatch on " + bytes.toHex(' ')).constData());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(Utf8Test)
+#include "Utf8Test.moc"
@@ -0,0 +1,126 @@
+// le_playlistgen — writes deterministic synthetic playlists for benchmarks and
+// soak runs of LunateEpsilonCli, e.g.
+//
+//   le_playlistgen --seed 7 --entries 10000000 --format m3u -o big.m3u
+//   le_playlistgen --messy 1 --non-ascii 0.5 --depth 3-8 --crlf -o messy.m3u
+
+#include "PlaylistGenerator.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <optional>
+#include <utility>
+
+namespace {
+
+std::optional<double> parseRatio(const QString& text)
+{
+    bool ok = false;
+    const double value = text.toDouble(&ok);
+    if (!ok || value < 0.0 || value > 1.0) return std::nullopt;
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("le_playlistgen");
+    app.setApplicationVersion("2.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates deterministic synthetic .m3u / .m3u8 playlists.");
+    parser.addHelpOption();
+
+    const QCommandLineOption outputOpt({"o", "output"}, "Output file. Defaults to stdout.", "path");
+    const QCommandLineOption seedOpt("seed", "PRNG seed (default 1).", "n", "1");
+    const QCommandLineOption entriesOpt({"n", "entries"}, "Number of playlist entries (default 1000).", "n", "1000");
+    const QCommandLineOption formatOpt("format", "m3u (library-relative) or m3u8 (absolute paths).", "format", "m3u");
+    const QCommandLineOption extinfOpt("extinf", "Ratio of entries with an #EXTINF line (default 0.5).", "ratio", "0.5");
+    const QCommandLineOption commentOpt("comments", "Ratio of extra comment lines (default 0.02).", "ratio", "0.02");
+    const QCommandLineOption blankOpt("blank", "Ratio of blank lines (default 0.02).", "ratio", "0.02");
+    const QCommandLineOption prefixOpt("music-prefix", "Ratio of M3U entries starting with Music/ (default 0.8).", "ratio", "0.8");
+    const QCommandLineOption messyOpt("messy", "Ratio of entries with messy separators (default 0.1).", "ratio", "0.1");
+    const QCommandLineOption nonAsciiOpt("non-ascii", "Ratio of non-ASCII path components (default 0.2).", "ratio", "0.2");
+    const QCommandLineOption depthOpt("depth", "Directory depth range, e.g. 2-4 (default).", "min-max", "2-4");
+    const QCommandLineOption crlfOpt("crlf", "Use CRLF line endings.");
+    const QCommandLineOption bomOpt("bom", "Start the file with a UTF-8 BOM.");
+
+    parser.addOptions({outputOpt, seedOpt, entriesOpt, formatOpt, extinfOpt, commentOpt, blankOpt,
+                       prefixOpt, messyOpt, nonAsciiOpt, depthOpt, crlfOpt, bomOpt});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const auto usageError = [&](const QString& message) {
+        err << message << Qt::endl;
+        return 2;
+    };
+
+    LE::GeneratorOptions options;
+    bool ok = false;
+
+    options.seed = parser.value(seedOpt).toULongLong(&ok);
+    if (!ok) return usageError("Invalid seed: " + parser.value(seedOpt));
+
+    options.entries = parser.value(entriesOpt).toLongLong(&ok);
+    if (!ok || options.entries < 0) return usageError("Invalid entry count: " + parser.value(entriesOpt));
+
+    const QString format = parser.value(formatOpt).toLower();
+    if (format == "m3u8") {
+        options.format = LE::GeneratorOptions::Format::M3u8;
+    } else if (format != "m3u") {
+        return usageError("Invalid format: " + format + " (expected m3u or m3u8)");
+    }
+
+    const std::pair<const QCommandLineOption*, double*> ratios[] = {
+        {&extinfOpt,   &options.extinfRatio},
+        {&commentOpt,  &options.commentRatio},
+        {&blankOpt,    &options.blankRatio},
+        {&prefixOpt,   &options.musicPrefixRatio},
+        {&messyOpt,    &options.messyRatio},
+        {&nonAsciiOpt, &options.nonAsciiRatio},
+    };
+    for (const auto& [option, target] : ratios) {
+        const auto value = parseRatio(parser.value(*option));
+        if (!value) return usageError(QString("Invalid --%1: expected a ratio in [0, 1]").arg(option->names().constLast()));
+        *target = *value;
+    }
+
+    const QStringList depth = parser.value(depthOpt).split('-');
+    bool minOk = false, maxOk = true;
+    options.minDepth = depth.value(0).toInt(&minOk);
+    options.maxDepth = (depth.size() == 2) ? depth[1].toInt(&maxOk) : options.minDepth;
+    if (!minOk || !maxOk || depth.size() > 2 || options.minDepth < 0 || options.maxDepth < options.minDepth) {
+        return usageError("Invalid --depth: " + parser.value(depthOpt));
+    }
+
+    options.crlf = parser.isSet(crlfOpt);
+    options.bom  = parser.isSet(bomOpt);
+
+    LE::PlaylistGenerator generator(options);
+
+    if (!parser.isSet(outputOpt)) {
+        QFile out;
+        if (!out.open(stdout, QIODevice::WriteOnly) || !generator.write(out)) {
+            err << "Write to stdout failed." << Qt::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    QSaveFile out(parser.value(outputOpt));
+    if (!out.open(QIODevice::WriteOnly)) {
+        err << "Cannot create " << out.fileName() << ": " << out.errorString() << Qt::endl;
+        return 1;
+    }
+    if (!generator.write(out) || !out.commit()) {
+        err << "Cannot write " << out.fileName() << ": " << out.errorString() << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
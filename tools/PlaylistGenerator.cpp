@@ -0,0 +1,189 @@
+#include "PlaylistGenerator.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace LE {
+
+namespace {
+
+const char* const kAsciiWords[] = {
+    "Midnight", "River", "Echoes", "Blue", "Summer", "Static", "Golden", "Hollow",
+    "Neon", "Paper", "Silver", "Wild", "Electric", "Velvet", "Distant", "Northern",
+    "Glass", "Broken", "Secret", "Shadow", "Ocean", "Fire", "Dream", "Stone",
+    "Light", "Heart", "City", "Road", "Rain", "Garden", "Live", "Remastered",
+};
+
+// Japanese, Chinese, Korean, Cyrillic, Greek, accented Latin and emoji
+// (outside the BMP, so paths also contain surrogate pairs).
+const char* const kNonAsciiWords[] = {
+    "東京", "夜明け", "アーティスト", "アルバム", "曲名", "北京", "音乐", "夜曲",
+    "서울", "노래", "사랑", "Москва", "Звезда", "Ночь", "Αθήνα", "Μουσική",
+    "Café", "Björk", "Sigur Rós", "Motörhead", "Beyoncé", "Señorita", "Naïve", "Zürich",
+    "🎵", "🎸", "Ωmega", "Ça va",
+};
+
+const char* const kExtensions[] = {"mp3", "flac", "m4a", "ogg", "wav", "opus"};
+
+const char* const kMessySeparators[] = {"/", "\\", "//", "\\\\", "/\\", "///"};
+
+constexpr qsizetype kFlushBytes = qsizetype(1) << 20;   // 1 MiB
+
+template <typename T, std::size_t N>
+constexpr int countOf(const T (&)[N]) noexcept
+{
+    return static_cast<int>(N);
+}
+
+} // namespace
+
+PlaylistGenerator::PlaylistGenerator(const GeneratorOptions& options)
+    : m_options(options)
+    , m_state(options.seed)
+{
+    m_options.minDepth = std::max(0, m_options.minDepth);
+    m_options.maxDepth = std::max(m_options.minDepth, m_options.maxDepth);
+}
+
+// SplitMix64: tiny, fast and fully specified, so output never depends on the
+// standard library or Qt version.
+std::uint64_t PlaylistGenerator::nextRandom()
+{
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int PlaylistGenerator::below(int bound)
+{
+    return static_cast<int>(nextRandom() % static_cast<std::uint64_t>(bound));
+}
+
+bool PlaylistGenerator::chance(double ratio)
+{
+    if (ratio <= 0.0) return false;
+    if (ratio >= 1.0) return true;
+    return static_cast<double>(nextRandom() >> 11) * 0x1.0p-53 < ratio;
+}
+
+QString PlaylistGenerator::word()
+{
+    return QString::fromUtf8(kAsciiWords[below(countOf(kAsciiWords))]);
+}
+
+QString PlaylistGenerator::separator(bool messy)
+{
+    if (messy) {
+        return QString::fromLatin1(kMessySeparators[below(countOf(kMessySeparators))]);
+    }
+    return (m_options.format == GeneratorOptions::Format::M3u) ? QStringLiteral("/") : QStringLiteral("\\");
+}
+
+QString PlaylistGenerator::nextEntry()
+{
+    QString title;
+    return nextEntry(title);
+}
+
+// Builds Artist / Album / [Disc N / …] / "NN - Title.ext", with each component
+// drawn from either the ASCII or the non-ASCII pool.
+QString PlaylistGenerator::nextEntry(QString& title)
+{
+    const bool messy = chance(m_options.messyRatio);
+
+    const auto phrase = [this] {
+        const bool nonAscii = chance(m_options.nonAsciiRatio);
+        const int words = 1 + below(3);
+        QString text;
+        for (int i = 0; i < words; ++i) {
+            if (i > 0) text += ' ';
+            text += nonAscii ? QString::fromUtf8(kNonAsciiWords[below(countOf(kNonAsciiWords))]) : word();
+        }
+        return text;
+    };
+
+    QString entry;
+    if (m_options.format == GeneratorOptions::Format::M3u8) {
+        entry += QChar(u'C' + below(3));
+        entry += ':';
+        entry += separator(messy);
+        entry += "Music";
+        entry += separator(messy);
+    } else if (chance(m_options.musicPrefixRatio)) {
+        entry += "Music";
+        entry += separator(messy);
+    }
+
+    const int depth = m_options.minDepth + below(m_options.maxDepth - m_options.minDepth + 1);
+    for (int level = 0; level < depth; ++level) {
+        switch (level) {
+            case 0:  entry += phrase(); break;
+            case 1:  entry += QString("%1 (%2)").arg(phrase()).arg(1960 + below(65)); break;
+            default: entry += (below(2) == 0) ? QString("Disc %1").arg(1 + below(4)) : phrase(); break;
+        }
+        entry += separator(messy);
+    }
+
+    title = phrase();
+    entry += QString("%1 - %2.%3")
+                 .arg(1 + below(30), 2, 10, QChar('0'))
+                 .arg(title)
+                 .arg(QLatin1String(kExtensions[below(countOf(kExtensions))]));
+
+    if (messy) {
+        if (below(4) == 0) entry += separator(true);
+        if (below(4) == 0) entry = QStringLiteral("  ") + entry + QStringLiteral("\t");
+    }
+    return entry;
+}
+
+bool PlaylistGenerator::write(QIODevice& device)
+{
+    const QByteArray eol = m_options.crlf ? QByteArrayLiteral("\r\n") : QByteArrayLiteral("\n");
+
+    QByteArray chunk;
+    chunk.reserve(kFlushBytes + 4096);
+
+    const auto flush = [&] {
+        const bool ok = device.write(chunk) == chunk.size();
+        chunk.resize(0);
+        return ok;
+    };
+
+    if (m_options.bom) {
+        chunk += "\xEF\xBB\xBF";
+    }
+    if (m_options.format == GeneratorOptions::Format::M3u8 || m_options.extinfRatio > 0.0) {
+        chunk += "#EXTM3U" + eol;
+    }
+
+    QString title;
+    for (qint64 i = 0; i < m_options.entries; ++i) {
+        if (chance(m_options.commentRatio)) {
+            chunk += "# Generated entry " + QByteArray::number(i) + eol;
+        }
+        if (chance(m_options.blankRatio)) {
+            chunk += (below(2) == 0) ? QByteArray() : QByteArrayLiteral("  \t");
+            chunk += eol;
+        }
+
+        const QString entry = nextEntry(title);
+        if (chance(m_options.extinfRatio)) {
+            // Separate statements: operand order of '+' is unspecified, and
+            // every draw must happen in the same order on every compiler.
+            const int seconds = 30 + below(570);
+            const QString artist = word();
+            chunk += "#EXTINF:" + QByteArray::number(seconds) + ',' + artist.toUtf8() + " - " + title.toUtf8() + eol;
+        }
+        chunk += entry.toUtf8();
+        chunk += eol;
+
+        if (chunk.size() >= kFlushBytes && !flush()) {
+            return false;
+        }
+    }
+    return flush();
+}
+
+} // namespace LE
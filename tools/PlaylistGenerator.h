@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+#include <cstdint>
+
+namespace LE {
+
+// Knobs for synthetic playlists. Ratios are probabilities in [0, 1].
+struct GeneratorOptions {
+    enum class Format {
+        M3u,    // Library-relative entries, '/' separators, optional "Music/" prefix
+        M3u8    // "#EXTM3U" header, absolute Windows paths
+    };
+
+    std::uint64_t seed    = 1;
+    qint64        entries = 1000;
+    Format        format  = Format::M3u;
+
+    double extinfRatio      = 0.5;    // Entries preceded by an #EXTINF directive
+    double commentRatio     = 0.02;   // Extra "# …" comment lines per entry
+    double blankRatio       = 0.02;   // Blank or whitespace-only lines per entry
+    double musicPrefixRatio = 0.8;    // M3U entries starting with "Music/"
+    double messyRatio       = 0.1;    // Entries with mixed, doubled or trailing separators
+    double nonAsciiRatio    = 0.2;    // Path components drawn from non-ASCII scripts
+
+    int  minDepth = 2;                // Directory levels above the file name
+    int  maxDepth = 4;
+    bool crlf     = false;
+    bool bom      = false;
+};
+
+// Deterministic generator of realistic playlists for benchmarks and soak runs.
+// The same options and seed always produce the same bytes, on every platform
+// and Qt version (the PRNG is SplitMix64, not QRandomGenerator).
+class PlaylistGenerator {
+public:
+    explicit PlaylistGenerator(const GeneratorOptions& options);
+
+    // Next entry path in the configured format, without any directives.
+    QString nextEntry();
+
+    // Writes a complete playlist: header, directives, blank lines and entries.
+    // Returns false if the device reports a write error.
+    bool write(QIODevice& device);
+
+private:
+    QString nextEntry(QString& title);
+
+    std::uint64_t nextRandom();
+    int below(int bound);
+    bool chance(double ratio);
+
+    QString word();
+    QString separator(bool messy);
+
+    GeneratorOptions m_options;
+    std::uint64_t    m_state;
+};
+
+} // namespace LE